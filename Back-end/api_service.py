@@ -11,18 +11,30 @@ Test:
 curl -X POST http://localhost:8000/api/schedule -H "Content-Type: application/json" -d @input.json
 """
 
-from fastapi import FastAPI, HTTPException, File, UploadFile
-from fastapi.responses import JSONResponse, FileResponse
+from fastapi import FastAPI, HTTPException, File, UploadFile, Request
+from fastapi.responses import JSONResponse, FileResponse, StreamingResponse
 from fastapi.middleware.cors import CORSMiddleware
 from pydantic import BaseModel
 from typing import Dict, List, Optional
+from concurrent.futures import ProcessPoolExecutor
+from contextlib import contextmanager
+from functools import partial
+import asyncio
+import multiprocessing
 import json
+import queue
+import time
 import pandas as pd
 from io import BytesIO
 import os
 
 # Import the scheduler
-from scheduler import schedule_timetable, ScheduledSession
+from scheduler import (schedule_timetable, schedule_alternatives, stream_timetable, init_preemption_flags,
+                       STRATEGIES)
+from editor import TimetableEditor, EditorStore
+from job_queue import (SolveJobQueue, AdmissionError, estimate_solve_seconds,
+                       PRIORITY_INTERACTIVE, PRIORITY_SOLVE, PRIORITY_BATCH)
+from tracing import TRACE_ENABLED, span, start_trace, stop_trace, current_tracer, clean_request_id
 
 app = FastAPI(
     title="University Timetable Scheduler API",
@@ -39,12 +51,84 @@ app.add_middleware(
     allow_headers=["*"],
 )
 
+# ==================== TRACING ====================
+
+# SCHEDULER_TRACE=1: each request to these paths writes traces/<request_id>.json
+# (Chrome trace-event format); the id comes from X-Request-Id when it is
+# [A-Za-z0-9_-]{1,64}, otherwise it is generated, and is echoed back in the
+# X-Request-Id response header.
+TRACED_PATHS = ("/api/schedule",)
+
+def _now_us() -> int:
+    return time.time_ns() // 1000
+
+class TraceMiddleware:
+    """ASGI middleware: request, body read and HTTP write spans around the traced handler"""
+    def __init__(self, app):
+        self.app = app
+
+    async def __call__(self, scope, receive, send):
+        if not TRACE_ENABLED or scope['type'] != 'http' or not scope['path'].startswith(TRACED_PATHS):
+            await self.app(scope, receive, send)
+            return
+
+        request_id = clean_request_id(dict(scope['headers']).get(b'x-request-id', b'').decode('latin-1'))
+        tracer = start_trace(request_id)
+        marks = scope.setdefault('state', {})
+        start = _now_us()
+
+        async def traced_receive():
+            message = await receive()
+            if message['type'] == 'http.request' and not message.get('more_body', False):
+                marks['body_received_us'] = _now_us()
+                tracer.add("http_read", start, marks['body_received_us'])
+            return message
+
+        async def traced_send(message):
+            if message['type'] == 'http.response.start':
+                marks['write_start_us'] = _now_us()
+                if 'handler_done_us' in marks:
+                    tracer.add("serialize_response", marks['handler_done_us'], marks['write_start_us'])
+                message['headers'] = list(message.get('headers', [])) + [(b'x-request-id', request_id.encode())]
+            await send(message)
+            if message['type'] == 'http.response.body' and not message.get('more_body', False):
+                tracer.add("http_write", marks.get('write_start_us', start), _now_us())
+
+        try:
+            await self.app(scope, traced_receive, traced_send)
+        finally:
+            tracer.add("request", start, _now_us(), {'method': scope['method'], 'path': scope['path']})
+            stop_trace()
+            path = await asyncio.to_thread(tracer.write)
+            print(f"Trace {request_id} written to {path}")
+
+@contextmanager
+def traced_handler(http_request: Request):
+    """
+    Inside a traced endpoint: records parse_request (body received to
+    handler entry: JSON decode and model validation) and marks the handler's
+    exit so the middleware can time response serialization
+    """
+    tracer = current_tracer()
+    marks = http_request.scope.get('state', {})
+    if tracer is not None and 'body_received_us' in marks:
+        tracer.add("parse_request", marks['body_received_us'], _now_us())
+    try:
+        yield
+    finally:
+        if tracer is not None:
+            marks['handler_done_us'] = _now_us()
+
+app.add_middleware(TraceMiddleware)
+
 # ==================== REQUEST MODELS ====================
 
 class ScheduleRequest(BaseModel):
     data: Dict
+    strategy: Optional[str] = "section"  # section, course, day, ga, or auto (picked by predicted solve time)
     max_time_seconds: Optional[int] = 300
     soft_constraints: Optional[List[str]] = []
+    columnar: Optional[bool] = False  # Return 'columns' instead of per-section 'schedule' rows
 
 class ScheduleResponse(BaseModel):
     status: str
@@ -52,7 +136,109 @@ class ScheduleResponse(BaseModel):
     solve_time: float
     total_sessions: Optional[int] = None
     schedule: Optional[List[Dict]] = None
+    columns: Optional[Dict] = None
     violations: Optional[List[str]] = []
+    strategy: Optional[str] = None  # The one that ran (auto resolved)
+    strategy_selection: Optional[Dict] = None  # strategy="auto": predicted seconds per strategy
+    peak_memory_mb: Optional[float] = None  # Peak RSS growth over the solve's start
+    memory: Optional[Dict] = None  # current/peak/per-structure MB and budget degradations
+
+class AlternativesRequest(BaseModel):
+    data: Dict
+    k: Optional[int] = 3
+    min_distance: Optional[int] = 20
+    max_time_seconds: Optional[int] = 300
+    workers: Optional[int] = None
+
+class EditSessionRequest(BaseModel):
+    data: Dict
+    schedule: List[Dict]
+
+class MoveRequest(BaseModel):
+    instance_id: str
+    day: str
+    start_period: int
+    room_id: Optional[str] = None
+
+# ==================== SOLVER POOL ====================
+
+# Solves run in worker processes so the event loop keeps serving other
+# requests (a solve holds the GIL for its whole run). Results come back as
+# ScheduleColumns, a few small arrays, and are expanded to rows here.
+# Jobs reach the pool through job_queue: priority classes, per-client caps,
+# cost-based admission and preemption of lower-priority solves.
+SOLVER_WORKERS = int(os.environ.get("SCHEDULER_WORKERS", os.cpu_count() or 2))
+preemption_flags = multiprocessing.RawArray('b', SOLVER_WORKERS)
+solve_pool = ProcessPoolExecutor(max_workers=SOLVER_WORKERS, initializer=init_preemption_flags,
+                                 initargs=(preemption_flags,))
+job_queue = SolveJobQueue(solve_pool, preemption_flags, SOLVER_WORKERS,
+                          client_cap=int(os.environ.get("SCHEDULER_CLIENT_CAP", 2)))
+
+def client_id_of(http_request: Request) -> str:
+    """Clients identify with X-Client-Id; otherwise the caller's address is used"""
+    client = http_request.client.host if http_request.client else "unknown"
+    return http_request.headers.get("X-Client-Id", client)
+
+def check_strategy(strategy: str):
+    if strategy not in STRATEGIES:
+        raise HTTPException(status_code=400,
+                            detail=f"Unknown strategy: {strategy} (one of {', '.join(STRATEGIES)})")
+
+def solve_priority(data: Dict) -> int:
+    """Warm starts from an existing timetable are interactive repairs"""
+    if data.get('pinned_assignments') or data.get('preferred_assignments'):
+        return PRIORITY_INTERACTIVE
+    return PRIORITY_SOLVE
+
+# Streamed solves send progress from the pool process through a manager queue
+_progress_manager = None
+
+def progress_queue():
+    global _progress_manager
+    if _progress_manager is None:
+        _progress_manager = multiprocessing.Manager()
+    return _progress_manager.Queue()
+
+async def run_schedule(data: Dict, max_time_seconds: int, columnar: bool = False,
+                       client_id: str = "unknown", strategy: str = "section") -> Dict:
+    """Solve in the pool; 'schedule' holds rows, or 'columns' holds the arrays if columnar"""
+    priority = solve_priority(data)
+    tracer = current_tracer()
+    with span("estimate_cost"):
+        estimated = await asyncio.to_thread(estimate_solve_seconds, data, strategy, max_time_seconds)
+    try:
+        with span("solve_job", priority=priority):
+            result = await job_queue.submit(priority, client_id, estimated, schedule_timetable, data,
+                                            strategy=strategy, max_time_seconds=max_time_seconds, columnar=True,
+                                            preemptible=True, trace_id=tracer.request_id if tracer else None)
+    except AdmissionError as e:
+        raise HTTPException(status_code=429, detail=str(e))
+
+    # Spans recorded in the pool process
+    trace_events = result.pop('trace_events', None)
+    if tracer is not None and trace_events:
+        tracer.extend(trace_events)
+
+    if result.get('schedule') is not None:
+        with span("expand_rows"):
+            if columnar:
+                result['columns'] = result.pop('schedule').to_lists()
+            else:
+                result['schedule'] = result['schedule'].to_rows(data)
+    return result
+
+# ==================== EDITING STATE ====================
+
+# Open editors, dropped after SCHEDULER_EDIT_TTL_SECONDS idle or when more
+# than SCHEDULER_EDIT_MAX_SESSIONS are open (least recently used first)
+edit_sessions = EditorStore(ttl_seconds=float(os.environ.get("SCHEDULER_EDIT_TTL_SECONDS", 3600)),
+                            max_sessions=int(os.environ.get("SCHEDULER_EDIT_MAX_SESSIONS", 64)))
+
+def get_editor(edit_session_id: str) -> TimetableEditor:
+    editor = edit_sessions.get(edit_session_id)
+    if editor is None:
+        raise HTTPException(status_code=404, detail=f"Unknown edit session: {edit_session_id}")
+    return editor
 
 # ==================== API ENDPOINTS ====================
 
@@ -65,7 +251,7 @@ def root():
     }
 
 @app.post("/api/schedule", response_model=ScheduleResponse)
-async def create_schedule(request: ScheduleRequest):
+async def create_schedule(request: ScheduleRequest, http_request: Request):
     """
     Generate a timetable schedule
 
@@ -78,6 +264,7 @@ async def create_schedule(request: ScheduleRequest):
             "sections": [...],
             "courses": [...]
         },
+        "strategy": "section",
         "max_time_seconds": 300,
         "soft_constraints": ["minimize_gaps", "balance_load"]
     }
@@ -91,100 +278,118 @@ async def create_schedule(request: ScheduleRequest):
                     status_code=400,
                     detail=f"Missing required field: {key}"
                 )
+        check_strategy(request.strategy)
 
         # Run scheduler
-        result = schedule_timetable(
-            request.data,
-            max_time_seconds=request.max_time_seconds
-        )
-
-        # Convert schedule to dict format
-        if 'schedule' in result and result['schedule']:
-            result['schedule'] = [
-                {
-                    'course_id': s.course_id,
-                    'session_type': s.session_type,
-                    'group_id': s.group_id,
-                    'sections': s.sections,
-                    'instructor_id': s.instructor_id,
-                    'room_id': s.room_id,
-                    'day': s.day,
-                    'start_period': s.start_period,
-                    'duration_periods': s.duration_periods
-                }
-                for s in result['schedule']
-            ]
-
-        return result
+        with traced_handler(http_request):
+            return await run_schedule(request.data, request.max_time_seconds, request.columnar,
+                                      client_id_of(http_request), request.strategy)
 
+    except HTTPException:
+        raise
     except Exception as e:
         raise HTTPException(
             status_code=500,
             detail=f"Scheduling error: {str(e)}"
         )
 
+@app.post("/api/schedule/stream")
+async def stream_schedule(request: ScheduleRequest, http_request: Request):
+    """
+    Solve through the job queue like /api/schedule (same admission,
+    priority and preemption) and stream NDJSON: progress events from the
+    cooperative search in the worker (at most twice a second; day and ga
+    send none) and a final result event, verified before it is sent.
+    Disconnecting cancels the job.
+    """
+    check_strategy(request.strategy)
+    data = request.data
+    priority = solve_priority(data)
+    estimated = await asyncio.to_thread(estimate_solve_seconds, data, request.strategy, request.max_time_seconds)
+    try:
+        job_queue.admit(priority, estimated)
+    except AdmissionError as e:
+        raise HTTPException(status_code=429, detail=str(e))
+
+    progress = progress_queue()
+    job = asyncio.ensure_future(job_queue.submit(
+        priority, client_id_of(http_request), estimated, stream_timetable, data, progress,
+        strategy=request.strategy, max_time_seconds=request.max_time_seconds, preemptible=True))
+
+    async def events():
+        try:
+            while not job.done():
+                try:
+                    event = await asyncio.to_thread(progress.get, timeout=0.25)
+                except queue.Empty:
+                    continue
+                yield json.dumps(event) + "\n"
+
+            try:
+                result = job.result()
+            except AdmissionError as e:
+                result = {'status': 'rejected', 'message': str(e)}
+            except Exception as e:
+                result = {'status': 'error', 'message': str(e)}
+            if result.get('schedule') is not None:
+                if request.columnar:
+                    result['columns'] = result.pop('schedule').to_lists()
+                else:
+                    result['schedule'] = result['schedule'].to_rows(data)
+            yield json.dumps({'event': 'result', 'result': result}) + "\n"
+        finally:
+            job.cancel()  # No-op once finished; otherwise the job leaves the queue or is stopped
+
+    return StreamingResponse(events(), media_type="application/x-ndjson")
+
 @app.post("/api/schedule/file")
-async def create_schedule_from_file(file: UploadFile = File(...)):
+async def create_schedule_from_file(http_request: Request, file: UploadFile = File(...)):
     """
     Generate schedule from uploaded JSON file
     """
     try:
-        contents = await file.read()
-        data = json.loads(contents)
-
-        result = schedule_timetable(data, max_time_seconds=300)
-
-        # Convert to dict
-        if 'schedule' in result and result['schedule']:
-            result['schedule'] = [
-                {
-                    'course_id': s.course_id,
-                    'session_type': s.session_type,
-                    'group_id': s.group_id,
-                    'sections': s.sections,
-                    'instructor_id': s.instructor_id,
-                    'room_id': s.room_id,
-                    'day': s.day,
-                    'start_period': s.start_period,
-                    'duration_periods': s.duration_periods
-                }
-                for s in result['schedule']
-            ]
-
-        return result
+        with traced_handler(http_request):
+            contents = await file.read()
+            with span("parse_json", bytes=len(contents)):
+                data = json.loads(contents)
+
+            return await run_schedule(data, max_time_seconds=300, client_id=client_id_of(http_request))
 
     except json.JSONDecodeError:
         raise HTTPException(status_code=400, detail="Invalid JSON file")
+    except HTTPException:
+        raise
     except Exception as e:
         raise HTTPException(status_code=500, detail=str(e))
 
 @app.post("/api/schedule/export/excel")
-async def export_schedule_excel(request: ScheduleRequest):
+async def export_schedule_excel(request: ScheduleRequest, http_request: Request):
     """
     Generate schedule and export as Excel file
     """
     try:
-        result = schedule_timetable(request.data, max_time_seconds=request.max_time_seconds)
+        check_strategy(request.strategy)
+        result = await run_schedule(request.data, request.max_time_seconds, client_id=client_id_of(http_request),
+                                    strategy=request.strategy)
 
         if result['status'] not in ['success', 'feasible']:
             raise HTTPException(status_code=500, detail=result['message'])
 
         # Convert to DataFrame
         schedule_data = []
-        day_names = ['Sunday', 'Monday', 'Tuesday', 'Wednesday', 'Thursday']
 
-        for session in result['schedule']:
+        for entry in result['schedule']:
             schedule_data.append({
-                'Course': session.course_id,
-                'Type': session.session_type,
-                'Group': session.group_id,
-                'Sections': ', '.join(session.sections),
-                'Instructor': session.instructor_id,
-                'Room': session.room_id,
-                'Day': day_names[session.day],
-                'Start Period': session.start_period,
-                'Duration (periods)': session.duration_periods,
-                'Start Time': f"{8 + session.start_period * 0.75:.0f}:{(session.start_period * 45 % 60):02.0f}",
+                'Course': entry['course_id'],
+                'Type': entry['type'],
+                'Group': entry['group_id'],
+                'Sections': entry['section_id'],
+                'Instructor': entry['instructor_id'],
+                'Room': entry['room_id'],
+                'Day': entry['day'],
+                'Start Period': entry['start_period'],
+                'Duration (periods)': entry['duration_periods'],
+                'Start Time': entry['time_slot'].split(' - ')[0],
             })
 
         df = pd.DataFrame(schedule_data)
@@ -213,9 +418,102 @@ async def export_schedule_excel(request: ScheduleRequest):
             filename=filename
         )
 
+    except HTTPException:
+        raise
     except Exception as e:
         raise HTTPException(status_code=500, detail=str(e))
 
+@app.post("/api/schedule/alternatives")
+async def create_alternatives(request: AlternativesRequest, http_request: Request):
+    """
+    Generate k meaningfully different timetables
+
+    Body:
+    {
+        "data": { ...same as /api/schedule... },
+        "k": 3,
+        "min_distance": 20,     # sessions on a different day/period between any two
+        "max_time_seconds": 300,
+        "workers": 4
+    }
+    """
+    # Batch class; runs its own worker processes (charged per process) and is not preempted
+    workers = request.workers or min(request.k, os.cpu_count() or 1)
+    try:
+        result = await job_queue.submit(
+            PRIORITY_BATCH, client_id_of(http_request), float(request.max_time_seconds), schedule_alternatives,
+            request.data,
+            processes=workers,
+            k=request.k,
+            min_distance=request.min_distance,
+            max_time_seconds=request.max_time_seconds,
+            workers=workers
+        )
+    except AdmissionError as e:
+        raise HTTPException(status_code=429, detail=str(e))
+    if result['status'] == 'failed':
+        raise HTTPException(status_code=500, detail=result['message'])
+    return result
+
+@app.post("/api/edit/sessions")
+def create_edit_session(request: EditSessionRequest):
+    """
+    Load a solved schedule for interactive editing
+
+    Body:
+    {
+        "data": { ...same as /api/schedule... },
+        "schedule": [ ...result['schedule'] entries... ]
+    }
+    """
+    try:
+        editor = TimetableEditor(request.data, request.schedule)
+    except (KeyError, ValueError) as e:
+        raise HTTPException(status_code=400, detail=f"Invalid schedule: {str(e)}")
+
+    edit_session_id = edit_sessions.add(editor)
+    return {
+        "edit_session_id": edit_session_id,
+        "total_sessions": len(editor.sessions),
+        "score": editor.score
+    }
+
+@app.post("/api/edit/sessions/{edit_session_id}/check")
+def check_move(edit_session_id: str, request: MoveRequest):
+    """Check whether a session can move to (day, start_period, room) without applying it"""
+    editor = get_editor(edit_session_id)
+    return editor.check_move(request.instance_id, request.day, request.start_period, request.room_id)
+
+@app.post("/api/edit/sessions/{edit_session_id}/move")
+def apply_move(edit_session_id: str, request: MoveRequest):
+    """Move a session if the move is valid"""
+    editor = get_editor(edit_session_id)
+    return editor.apply_move(request.instance_id, request.day, request.start_period, request.room_id)
+
+@app.get("/api/edit/sessions/{edit_session_id}")
+def get_edit_session(edit_session_id: str):
+    """Current schedule of an edit session"""
+    editor = get_editor(edit_session_id)
+    schedule = editor.get_schedule()
+    return {
+        "edit_session_id": edit_session_id,
+        "score": editor.score,
+        "total_sessions": len(schedule),
+        "schedule": schedule
+    }
+
+@app.delete("/api/edit/sessions/{edit_session_id}")
+def close_edit_session(edit_session_id: str):
+    """Drop an edit session"""
+    if not edit_sessions.remove(edit_session_id):
+        raise HTTPException(status_code=404, detail=f"Unknown edit session: {edit_session_id}")
+    return {"status": "closed"}
+
+@app.get("/api/jobs")
+def get_jobs():
+    """Running and queued solve jobs per priority class"""
+    return job_queue.stats()
+
 @app.get("/api/health")
 def health_check():
     """Health check endpoint"""
@@ -275,6 +573,12 @@ async def startup_event():
     print("  POST /api/schedule                 - Generate schedule from JSON")
     print("  POST /api/schedule/file            - Generate schedule from file upload")
     print("  POST /api/schedule/export/excel    - Generate & export as Excel")
+    print("  POST /api/schedule/alternatives    - Generate k diverse schedules")
+    print("  POST /api/schedule/stream          - Solve with streamed progress (NDJSON)")
+    print("  POST /api/edit/sessions            - Start editing a schedule")
+    print("  POST /api/edit/sessions/{id}/check - Check a session move")
+    print("  POST /api/edit/sessions/{id}/move  - Apply a session move")
+    print("  GET  /api/jobs                     - Solve job queue status")
     print("  GET  /api/health                   - Health check")
     print("  GET  /                             - API info")
     print("\nDocs available at: http://localhost:8000/docs")
@@ -0,0 +1,258 @@
+"""
+Microbenchmarks for the solver's hot primitives
+Times conflict checks, place/undo, candidate enumeration, session
+compilation, search steps and result extraction on realistic states of
+the input.py instance:
+  mid  - the section search stopped partway (iter_search)
+  late - the committed schedule_backtracking.json pinned back in
+         (near-complete; entries that no longer fit are dropped)
+
+Usage:
+python benchmark.py [--repeat N] [--only name,...] [--perf] [--save results.json] [--compare baseline.json]
+
+--perf adds cache misses per op from Linux `perf stat` (hardware counters
+are not visible from Python); it is skipped when perf is not installed.
+
+Comparing commits: run with --save on one checkout, then with
+--compare on the other.
+"""
+
+from typing import List, Dict, Callable, Tuple, Optional
+import argparse
+import io
+import contextlib
+import json
+import os
+import random
+import shutil
+import statistics
+import subprocess
+import sys
+import time
+
+from scheduler import BacktrackingScheduler
+from input import DATA
+
+SCHEDULE_FILE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "schedule_backtracking.json")
+
+# Suspended searches behind the mid states (closing one unwinds its placements)
+_suspended_searches = []
+
+# ==================== STATES ====================
+
+def capture_mid_state(steps: int = 150) -> BacktrackingScheduler:
+    """Section search stopped after steps * 4096 attempts"""
+    scheduler = BacktrackingScheduler(DATA)
+    search = scheduler.iter_search(
+        scheduler._search_order("section", scheduler._get_strategy_sessions("section")))
+    for _ in range(steps):
+        if next(search, None) is None:
+            break
+    _suspended_searches.append(search)
+    return scheduler
+
+def capture_late_state() -> BacktrackingScheduler:
+    """The committed schedule pinned back in, minus entries that no longer fit"""
+    data = dict(DATA)
+    if os.path.exists(SCHEDULE_FILE):
+        with open(SCHEDULE_FILE) as f:
+            data['pinned_assignments'] = json.load(f)['schedule']
+    scheduler = BacktrackingScheduler(data)
+    session_ids = scheduler._get_strategy_sessions("section")
+    scheduler._apply_assignment_hints(session_ids)
+    return scheduler
+
+def sample_candidates(scheduler: BacktrackingScheduler, count: int, rng: random.Random) -> List[Tuple]:
+    """(session, day, period, instructor, room) drawn uniformly from every session's value space"""
+    sessions = [s for s in scheduler.compiled_sessions if s.instructors and s.rooms]
+    candidates = []
+    for _ in range(count):
+        session = rng.choice(sessions)
+        candidates.append((session, rng.choice(session.days), rng.choice(session.periods),
+                           rng.choice(session.instructors), rng.choice(session.rooms)))
+    return candidates
+
+# ==================== BENCHMARKS ====================
+# Each returns (function running a batch, operations per batch)
+
+def bench_conflict_check(scheduler: BacktrackingScheduler) -> Tuple[Callable, int]:
+    candidates = sample_candidates(scheduler, 20000, random.Random(1))
+    check = scheduler._is_valid_assignment
+
+    def run():
+        for session, day, period, instructor_id, room_id in candidates:
+            check(session.sections, day, period, session.duration, instructor_id, room_id, session.cluster_indices)
+    return run, len(candidates)
+
+def bench_session_check(scheduler: BacktrackingScheduler) -> Tuple[Callable, int]:
+    """The search loops' check: compiled session id against the session columns"""
+    candidates = sample_candidates(scheduler, 20000, random.Random(1))
+    check = scheduler._is_valid_session
+
+    def run():
+        for session, day, period, instructor_id, room_id in candidates:
+            check(session.session_id, day, period, instructor_id, room_id)
+    return run, len(candidates)
+
+def bench_place_undo(scheduler: BacktrackingScheduler) -> Tuple[Callable, int]:
+    from scheduler import Assignment
+
+    valid = []
+    for session, day, period, instructor_id, room_id in sample_candidates(scheduler, 200000, random.Random(2)):
+        if scheduler.placed_sessions >> session.session_id & 1:
+            continue
+        if scheduler._is_valid_assignment(session.sections, day, period, session.duration,
+                                          instructor_id, room_id, session.cluster_indices):
+            valid.append(Assignment(
+                course_id=session.course.course_id, session_type=session.kind.type, sections=session.sections,
+                instructor_id=instructor_id, room_id=room_id, day=day, period=period,
+                duration=session.duration, session_id=session.session_id))
+        if len(valid) >= 2000:
+            break
+
+    def run():
+        for assignment in valid:
+            scheduler._place_assignment(assignment)
+            scheduler._remove_assignment(assignment)
+    return run, max(len(valid), 1)
+
+def bench_enumerate_candidates(scheduler: BacktrackingScheduler) -> Tuple[Callable, int]:
+    rng = random.Random(3)
+    sessions = rng.sample([s for s in scheduler.compiled_sessions
+                           if s.instructors and s.rooms and not scheduler.placed_sessions >> s.session_id & 1], 40)
+    check = scheduler._is_valid_session
+    total = sum(len(s.days) * len(s.periods) * len(s.instructors) * len(s.rooms) for s in sessions)
+
+    def run():
+        for session in sessions:
+            for day in session.days:
+                for period in session.periods:
+                    for instructor_id in session.instructors:
+                        for room_id in session.rooms:
+                            check(session.session_id, day, period, instructor_id, room_id)
+    return run, total
+
+def bench_compile(_) -> Tuple[Callable, int]:
+    def run():
+        scheduler = BacktrackingScheduler(DATA)
+        scheduler._get_strategy_sessions("section")
+    return run, 1
+
+def bench_search_steps(_) -> Tuple[Callable, int]:
+    """Search attempts from a fresh state (includes place/undo and backtracking)"""
+    def run():
+        scheduler = BacktrackingScheduler(DATA)
+        search = scheduler.iter_search(
+            scheduler._search_order("section", scheduler._get_strategy_sessions("section")))
+        for _ in range(25):
+            next(search, None)
+    return run, 25 * 4096
+
+def bench_extract_solution(scheduler: BacktrackingScheduler) -> Tuple[Callable, int]:
+    def run():
+        scheduler._extract_solution(0.0)
+    return run, 1
+
+def bench_extract_columns(scheduler: BacktrackingScheduler) -> Tuple[Callable, int]:
+    def run():
+        scheduler._extract_columns()
+    return run, 1
+
+BENCHMARKS = [
+    ("conflict_check[mid]", "mid", bench_conflict_check),
+    ("conflict_check[late]", "late", bench_conflict_check),
+    ("session_check[mid]", "mid", bench_session_check),
+    ("session_check[late]", "late", bench_session_check),
+    ("place_undo[mid]", "mid", bench_place_undo),
+    ("enumerate_candidates[mid]", "mid", bench_enumerate_candidates),
+    ("compile", None, bench_compile),
+    ("search_steps", None, bench_search_steps),
+    ("extract_solution[late]", "late", bench_extract_solution),
+    ("extract_columns[late]", "late", bench_extract_columns),
+]
+
+# ==================== RUNNER ====================
+
+def run_benchmarks(repeat: int, only: List[str], perf: bool = False) -> Dict[str, Dict]:
+    states = {}
+    results = {}
+    for name, state, bench in BENCHMARKS:
+        if only and not any(o in name for o in only):
+            continue
+        if state and state not in states:
+            with contextlib.redirect_stdout(io.StringIO()):
+                states[state] = capture_mid_state() if state == "mid" else capture_late_state()
+            placed = states[state].placed_sessions.bit_count()
+            print(f"State {state}: {placed}/{len(states[state].compiled_sessions)} sessions placed")
+
+        run, ops = bench(states.get(state))
+        run()  # Warm up
+        times = []
+        with contextlib.redirect_stdout(io.StringIO()):
+            for _ in range(repeat):
+                start = time.perf_counter_ns()
+                run()
+                times.append((time.perf_counter_ns() - start) / ops)
+        if not times:
+            continue  # Setup-only run (perf baseline)
+
+        results[name] = {
+            'ns_per_op': min(times),
+            'median_ns_per_op': statistics.median(times),
+            'ops_per_batch': ops,
+            'cache_misses_per_op': perf_cache_misses(name, repeat, ops) if perf else None
+        }
+        misses = results[name]['cache_misses_per_op']
+        print(f"{name:28s} {min(times):12,.0f} ns/op  (median {statistics.median(times):,.0f}, {ops:,} ops/batch)"
+              + (f"  {misses:,.2f} cache misses/op" if misses is not None else ""))
+
+    if perf and shutil.which("perf") is None:
+        print("perf not found: cache misses not measured")
+    return results
+
+def perf_cache_misses(name: str, repeat: int, ops: int) -> Optional[float]:
+    """
+    Cache misses per op from `perf stat`: the benchmark process with repeat
+    batches minus the same process with none (setup and warm-up only).
+    None when perf or the counter is unavailable.
+    """
+    if shutil.which("perf") is None:
+        return None
+    counts = []
+    for batches in (repeat, 0):
+        proc = subprocess.run(
+            ["perf", "stat", "-x,", "-e", "cache-misses", sys.executable, os.path.abspath(__file__),
+             "--only", name, "--repeat", str(batches)],
+            capture_output=True, text=True)
+        fields = proc.stderr.strip().splitlines()[-1].split(",") if proc.stderr.strip() else []
+        if proc.returncode != 0 or not fields or not fields[0].isdigit():
+            return None
+        counts.append(int(fields[0]))
+    return max(counts[0] - counts[1], 0) / (ops * repeat)
+
+def compare(results: Dict[str, Dict], baseline: Dict[str, Dict]):
+    print(f"\n{'benchmark':28s} {'baseline':>12s} {'current':>12s} {'change':>8s}")
+    for name, r in results.items():
+        if name not in baseline:
+            continue
+        before, after = baseline[name]['ns_per_op'], r['ns_per_op']
+        print(f"{name:28s} {before:12,.0f} {after:12,.0f} {(after - before) / before * 100:+7.1f}%")
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Microbenchmarks for the solver's hot primitives")
+    parser.add_argument("--repeat", type=int, default=5, help="Batches per benchmark (best is reported)")
+    parser.add_argument("--only", default="", help="Comma-separated name filters")
+    parser.add_argument("--perf", action="store_true", help="Also count cache misses per op with `perf stat`")
+    parser.add_argument("--save", help="Write results as JSON")
+    parser.add_argument("--compare", help="Baseline JSON from --save to compare against")
+    args = parser.parse_args()
+
+    results = run_benchmarks(args.repeat, [o for o in args.only.split(",") if o], args.perf)
+
+    if args.save:
+        with open(args.save, 'w') as f:
+            json.dump({'python': sys.version.split()[0], 'results': results}, f, indent=2)
+        print(f"\nSaved to {args.save}")
+    if args.compare:
+        with open(args.compare) as f:
+            compare(results, json.load(f)['results'])
@@ -0,0 +1,63 @@
+"""
+Shared fixtures for the behavior tests
+small_data is a fresh two-year instance per test: three first-year
+sections share a two-section lab, second year has a graduation project,
+and rooms sit in two buildings. solve runs schedule_timetable and checks
+the result is a verified success; solved is small_data solved by section.
+"""
+
+import pytest
+
+from scheduler import schedule_timetable
+
+def make_small_data():
+    sections = [{"section_id": f"Y1-G1-S{i}", "group_id": "Y1-G1", "students_count": 20} for i in (1, 2, 3)]
+    sections += [{"section_id": f"Y2-G1-S{i}", "group_id": "Y2-G1", "students_count": 25} for i in (1, 2)]
+    return {
+        "rooms": [
+            {"room_id": "CR1", "type": "classroom", "capacity": 100, "building": "B1"},
+            {"room_id": "CR2", "type": "classroom", "capacity": 60, "building": "B2"},
+            {"room_id": "LAB1", "type": "computer lab", "capacity": 70, "building": "B2"},
+            {"room_id": "TH1", "type": "theater", "capacity": 200, "building": "B1"},
+        ],
+        "instructors": [
+            {"instr_id": "P1", "name": "Prof 1", "role": "Professor", "qualified_courses": ["C101", "C102", "C201"]},
+            {"instr_id": "P2", "name": "Prof 2", "role": "Professor", "qualified_courses": ["C101", "C201"]},
+            {"instr_id": "T1", "name": "TA 1", "role": "TA", "qualified_courses": ["C101", "C102", "C201"]},
+            {"instr_id": "T2", "name": "TA 2", "role": "TA", "qualified_courses": ["C101", "C102"]},
+        ],
+        "groups": [
+            {"group_id": "Y1-G1", "year": 1, "specialization": None, "sections_count": 3, "students_count": 60},
+            {"group_id": "Y2-G1", "year": 2, "specialization": None, "sections_count": 2, "students_count": 50},
+        ],
+        "sections": sections,
+        "courses": [
+            {"course_id": "C101", "name": "Course 101", "year": 1, "major": None,
+             "kinds": [{"type": "Lecture", "length": 90}, {"type": "Tut", "length": 45},
+                       {"type": "Lab", "length": 90, "lab_type": "computer lab", "max_sections_together": 2}]},
+            {"course_id": "C102", "name": "Course 102", "year": 1, "major": None,
+             "kinds": [{"type": "Lecture", "length": 90}, {"type": "Tut", "length": 90}]},
+            {"course_id": "C201", "name": "Course 201", "year": 2, "major": None,
+             "kinds": [{"type": "Lecture", "length": 90}, {"type": "Tut", "length": 45}]},
+            {"course_id": "PRJ2", "name": "Graduation Project", "year": 2, "major": None,
+             "kinds": [{"type": "Lecture", "length": 360}], "is_project": True},
+        ],
+    }
+
+@pytest.fixture
+def small_data():
+    return make_small_data()
+
+@pytest.fixture
+def solve():
+    def solve(data, strategy: str = "section"):
+        result = schedule_timetable(data, strategy=strategy, max_time_seconds=30)
+        assert result['status'] == 'success', result.get('message')
+        assert result['violations'] == []
+        return result
+    return solve
+
+@pytest.fixture
+def solved(small_data, solve):
+    """(data, schedule) of small_data solved by section"""
+    return small_data, solve(small_data)['schedule']
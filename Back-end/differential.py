@@ -0,0 +1,321 @@
+"""
+Differential testing between the reference scheduler and another engine
+Generates random instances, runs both engines on each, compares their
+feasibility verdicts and checks every solution the candidate returns
+with the independent verifier (hard constraints) plus a coverage check
+(every required session placed exactly once). The reference is the
+baseline scheduler (test_backtracking.py), which also defines the
+coverage, so a change to scheduler.py cannot move both sides of the
+comparison at once. Reports speedups on the instances both engines solved.
+
+Usage:
+python differential.py [--instances N] [--seed S] [--size small|medium]
+                       [--time-limit SECONDS] [--reference ENGINE] [--candidate ENGINE]
+                       [--save report.json]
+
+ENGINE is one of
+  baseline              the baseline scheduler of test_backtracking.py, placing every session
+                        of its expansion (exhaustive search, so a failure proves infeasibility;
+                        runs in a child process so the time limit can stop it)
+  python:<strategy>     schedule_timetable in this process (section, course, day, ga, auto)
+  cmd:<command line>    a program reading {"data", "max_time_seconds"} JSON on stdin and
+                        writing a result (status, schedule in the _extract_solution format)
+                        to stdout, e.g. the native engine's CLI
+  http://host:port/...  a server speaking the /api/schedule protocol
+The reference defaults to baseline, the candidate to SCHEDULER_NATIVE_ENGINE,
+else python:section.
+
+Exit code 1 if any verdicts disagree or any candidate solution is invalid.
+"""
+
+from typing import List, Dict, Callable, Tuple
+from collections import Counter
+import argparse
+import contextlib
+import io
+import json
+import math
+import multiprocessing
+import os
+import random
+import shlex
+import subprocess
+import sys
+import time
+import urllib.request
+
+from scheduler import schedule_timetable
+from test_backtracking import BacktrackingScheduler as BaselineScheduler
+from verifier import verify_schedule, DAY_NAMES
+
+# ==================== INSTANCE GENERATOR ====================
+
+SIZES = {
+    # years, groups per year, sections per group, courses per year
+    "small": (2, (1, 2), (1, 3), (2, 3)),
+    "medium": (3, (1, 3), (2, 4), (3, 5)),
+}
+
+def generate_instance(seed: int, size: str = "small") -> Dict:
+    """
+    Random instance in the input.py format. Room and instructor supply is
+    drawn around the demand, so some instances are infeasible.
+    """
+    rng = random.Random(seed)
+    years, groups_range, sections_range, courses_range = SIZES[size]
+
+    groups, sections, courses = [], [], []
+    for year in range(1, years + 1):
+        for g in range(rng.randint(*groups_range)):
+            group_id = f"Y{year}-G{g + 1}"
+            count = rng.randint(*sections_range)
+            sizes = [rng.randint(12, 25) for _ in range(count)]
+            groups.append({"group_id": group_id, "year": year, "specialization": None,
+                           "sections_count": count, "students_count": sum(sizes)})
+            for s, students in enumerate(sizes):
+                sections.append({"section_id": f"{group_id}-S{s + 1}", "group_id": group_id,
+                                 "students_count": students})
+
+        for c in range(rng.randint(*courses_range)):
+            kinds = [{"type": "Lecture", "length": 90}]
+            if rng.random() < 0.6:
+                kinds.append({"type": "Tut", "length": rng.choice([45, 90])})
+            if rng.random() < 0.5:
+                kinds.append({"type": "Lab", "length": 90, "lab_type": "computer lab",
+                              "max_sections_together": rng.randint(1, 2)})
+            courses.append({"course_id": f"C{year}{c + 1:02d}", "name": f"Course {year}.{c + 1}",
+                            "year": year, "major": None, "kinds": kinds})
+
+    largest_group = max(g['students_count'] for g in groups)
+    rooms = [{"room_id": f"CR{i + 1}", "type": "classroom", "capacity": rng.choice([30, 50, 100]),
+              "building": "B1"} for i in range(rng.randint(2, 4))]
+    rooms += [{"room_id": f"LAB{i + 1}", "type": "computer lab", "capacity": 70, "building": "B2"}
+              for i in range(rng.randint(1, 2))]
+    rooms.append({"room_id": "TH1", "type": "theater", "capacity": max(200, largest_group), "building": "B3"})
+
+    # Every course gets a qualified professor; a TA too when it has tutorials or labs
+    instructors = []
+    course_ids = [c['course_id'] for c in courses]
+    for role, prefix in (("Professor", "P"), ("TA", "T")):
+        count = max(2, len(courses) * 2 // 3)
+        qualified = [[] for _ in range(count)]
+        for course in courses:
+            if role == "TA" and len(course['kinds']) == 1:
+                continue
+            for i in rng.sample(range(count), rng.randint(1, min(2, count))):
+                qualified[i].append(course['course_id'])
+        for i in range(count):
+            extra = rng.sample(course_ids, min(len(course_ids), rng.randint(0, 1)))
+            instructors.append({"instr_id": f"{prefix}{i + 1}", "name": f"{role} {i + 1}", "role": role,
+                                "qualified_courses": sorted(set(qualified[i]) | set(extra))})
+
+    return {"rooms": rooms, "instructors": instructors, "groups": groups,
+            "sections": sections, "courses": courses}
+
+# ==================== ENGINES ====================
+
+def baseline_rows(schedule: List[Dict]) -> List[Dict]:
+    """Baseline sessions (section lists, 0-based periods) as _extract_solution rows"""
+    return [{'course_id': session['course_id'], 'type': session['session_type'], 'section_id': section_id,
+             'instructor_id': session['instructor_id'], 'room_id': session['room_id'],
+             'day': DAY_NAMES[session['day']], 'start_period': session['start_period'] + 1,
+             'duration_periods': session['duration_periods']}
+            for session in schedule for section_id in session['sections']]
+
+class CompleteBaseline(BaselineScheduler):
+    """
+    The baseline search, except that it places every session of its
+    expansion. The baseline skips a session once its sections have any
+    session of the course (scheduled_courses holds course ids), so after a
+    lecture it never placed the course's tutorial or lab and every solution
+    failed coverage. Forgetting the course ids disables that skip; the
+    expansion lists each session once, so nothing is placed twice.
+    """
+    def _place_assignment(self, assignment):
+        super()._place_assignment(assignment)
+        for section_id in assignment.sections:
+            self.scheduled_courses[section_id].discard(assignment.course_id)
+
+def _run_baseline(data: Dict) -> Dict:
+    """Child process entry: the baseline search, which has no time limit of its own"""
+    with contextlib.redirect_stdout(io.StringIO()):
+        result = CompleteBaseline(data).solve()
+    if result['status'] == 'success':
+        result['schedule'] = baseline_rows(result['schedule'])
+    else:
+        result['exhausted'] = True  # Complete search: a failure proves infeasibility
+    return result
+
+def make_engine(spec: str) -> Callable[[Dict, int], Dict]:
+    """Engine spec -> fn(data, max_time_seconds) returning a result dict"""
+    if spec == "baseline":
+        def run(data, max_time_seconds):
+            with multiprocessing.Pool(1) as pool:
+                try:
+                    return pool.apply_async(_run_baseline, (data,)).get(max_time_seconds)
+                except multiprocessing.TimeoutError:
+                    return {'status': 'timeout', 'message': 'Time limit reached'}
+        return run
+
+    if spec.startswith("python:"):
+        strategy = spec.split(":", 1)[1]
+
+        def run(data, max_time_seconds):
+            with contextlib.redirect_stdout(io.StringIO()):
+                return schedule_timetable(data, strategy=strategy, max_time_seconds=max_time_seconds)
+        return run
+
+    if spec.startswith("cmd:"):
+        command = shlex.split(spec.split(":", 1)[1])
+
+        def run(data, max_time_seconds):
+            proc = subprocess.run(command, input=json.dumps({"data": data, "max_time_seconds": max_time_seconds}),
+                                  capture_output=True, text=True, timeout=max_time_seconds * 2 + 10)
+            if proc.returncode != 0 and not proc.stdout.strip():
+                return {'status': 'error', 'message': proc.stderr.strip()[-500:]}
+            return json.loads(proc.stdout)
+        return run
+
+    if spec.startswith("http://") or spec.startswith("https://"):
+        def run(data, max_time_seconds):
+            request = urllib.request.Request(
+                spec, data=json.dumps({"data": data, "max_time_seconds": max_time_seconds}).encode(),
+                headers={"Content-Type": "application/json"})
+            with urllib.request.urlopen(request, timeout=max_time_seconds * 2 + 10) as response:
+                return json.loads(response.read())
+        return run
+
+    raise ValueError(f"Unknown engine: {spec}")
+
+# ==================== CHECKS ====================
+
+def required_coverage(data: Dict) -> Counter:
+    """
+    (course_id, type, section_id) -> times it must appear, from the
+    baseline session expansion (generated instances have no graduation
+    projects, which the baseline expands for the first section's group only)
+    """
+    coverage = Counter()
+    for course, kind, sections in BaselineScheduler(data)._get_all_sessions_to_schedule():
+        for section_id in sections:
+            coverage[(course.course_id, kind.type, section_id)] += 1
+    return coverage
+
+def check_solution(data: Dict, schedule: List[Dict], coverage: Counter) -> List[str]:
+    """Hard-constraint violations plus missing or duplicated sessions (against coverage, not the verifier's)"""
+    problems = [v['message'] for v in verify_schedule(data, schedule)['violations']
+                if v['type'] != 'missing_session']
+    placed = Counter((e.get('course_id'), e.get('type', e.get('session_type')), e.get('section_id'))
+                     for e in schedule)
+    for key, count in (coverage - placed).items():
+        problems.append(f"{key[0]} ({key[1]}) for {key[2]} missing ({count})")
+    for key, count in (placed - coverage).items():
+        problems.append(f"{key[0]} ({key[1]}) for {key[2]} placed {count} extra time(s)")
+    return problems
+
+def run_engine(engine: Callable, data: Dict, time_limit: int, coverage: Counter) -> Dict:
+    """
+    Run one engine; verdict is feasible, invalid (a solution that fails the
+    checks proves nothing), infeasible (search exhausted), unknown (time
+    limit) or error
+    """
+    start = time.time()
+    try:
+        result = engine(data, time_limit)
+    except Exception as e:
+        result = {'status': 'error', 'message': str(e)}
+    wall = time.time() - start
+
+    status = result.get('status')
+    run = {'status': status, 'time': wall, 'problems': []}
+    if status == 'success':
+        run['problems'] = check_solution(data, result.get('schedule') or [], coverage)
+        run['verdict'] = 'invalid' if run['problems'] else 'feasible'
+    elif status == 'failed':
+        # Only a search that reports it exhausted the space proves infeasibility
+        run['verdict'] = 'infeasible' if result.get('exhausted') else 'unknown'
+    elif status == 'error':
+        run['verdict'] = 'error'
+        run['problems'] = [result.get('message', 'error')]
+    else:
+        run['verdict'] = 'unknown'
+    return run
+
+# ==================== HARNESS ====================
+
+def run_differential(reference: str, candidate: str, instances: int, seed: int, size: str,
+                     time_limit: int) -> Dict:
+    ref_engine, cand_engine = make_engine(reference), make_engine(candidate)
+    cases = []
+    print(f"{'seed':>6} {'sessions':>8}  {'reference':>19}  {'candidate':>19}  {'speedup':>7}  issues")
+
+    for i in range(instances):
+        instance_seed = seed + i
+        data = generate_instance(instance_seed, size)
+        coverage = required_coverage(data)
+
+        ref = run_engine(ref_engine, data, time_limit, coverage)
+        cand = run_engine(cand_engine, data, time_limit, coverage)
+
+        issues = []
+        verdicts = {ref['verdict'], cand['verdict']}
+        if verdicts == {'feasible', 'infeasible'}:
+            issues.append(f"verdicts disagree (reference {ref['verdict']}, candidate {cand['verdict']})")
+        if cand['problems']:
+            issues.append(f"candidate: {len(cand['problems'])} problem(s), first: {cand['problems'][0]}")
+        if ref['problems']:
+            issues.append(f"reference: {len(ref['problems'])} problem(s), first: {ref['problems'][0]}")
+
+        speedup = ref['time'] / max(cand['time'], 1e-9) if ref['verdict'] == cand['verdict'] == 'feasible' else None
+        cases.append({'seed': instance_seed, 'sessions': sum(coverage.values()),
+                      'reference': ref, 'candidate': cand, 'speedup': speedup, 'issues': issues})
+
+        print(f"{instance_seed:>6} {sum(coverage.values()):>8}  "
+              f"{ref['verdict']:>11} {ref['time']:6.2f}s  {cand['verdict']:>11} {cand['time']:6.2f}s  "
+              f"{(f'{speedup:.3g}x' if speedup else '-'):>7}  {'; '.join(issues)}")
+
+    speedups = [c['speedup'] for c in cases if c['speedup']]
+    summary = {
+        'reference': reference,
+        'candidate': candidate,
+        'instances': instances,
+        'both_feasible': len(speedups),
+        'disagreements': sum(1 for c in cases if any(i.startswith("verdicts") for i in c['issues'])),
+        'invalid_solutions': sum(1 for c in cases if c['candidate']['verdict'] == 'invalid'),
+        'invalid_reference_solutions': sum(1 for c in cases if c['reference']['verdict'] == 'invalid'),
+        'unknown': sum(1 for c in cases if 'unknown' in (c['reference']['verdict'], c['candidate']['verdict'])),
+        'geomean_speedup': math.exp(sum(math.log(s) for s in speedups) / len(speedups)) if speedups else None
+    }
+    return {'summary': summary, 'cases': cases}
+
+# ==================== CLI ====================
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Differential testing of a scheduling engine against the reference")
+    parser.add_argument("--instances", type=int, default=20)
+    parser.add_argument("--seed", type=int, default=0)
+    parser.add_argument("--size", choices=sorted(SIZES), default="small")
+    parser.add_argument("--time-limit", type=int, default=30, help="Seconds per engine per instance")
+    parser.add_argument("--reference", default="baseline")
+    parser.add_argument("--candidate", default=os.environ.get("SCHEDULER_NATIVE_ENGINE", "python:section"))
+    parser.add_argument("--save", help="Write the full report as JSON")
+    args = parser.parse_args()
+
+    report = run_differential(args.reference, args.candidate, args.instances, args.seed, args.size,
+                              args.time_limit)
+    summary = report['summary']
+
+    print(f"\nReference: {summary['reference']}   Candidate: {summary['candidate']}")
+    print(f"Both feasible: {summary['both_feasible']}/{summary['instances']}   "
+          f"Unknown (time limit): {summary['unknown']}")
+    print(f"Disagreements: {summary['disagreements']}   Invalid solutions: {summary['invalid_solutions']}   "
+          f"Invalid reference solutions: {summary['invalid_reference_solutions']}")
+    if summary['geomean_speedup']:
+        print(f"Speedup (geometric mean): {summary['geomean_speedup']:.2f}x")
+
+    if args.save:
+        with open(args.save, 'w') as f:
+            json.dump(report, f, indent=2)
+        print(f"Saved to {args.save}")
+
+    sys.exit(1 if summary['disagreements'] or summary['invalid_solutions'] else 0)
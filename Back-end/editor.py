@@ -0,0 +1,392 @@
+"""
+Interactive timetable editing
+Holds one solved schedule as compact slot bitsets and answers
+"can this session move to (day, period, room)?" without re-solving.
+Moves are checked against every hard rule the verifier knows: overlaps
+(sections, student clusters, instructors, rooms), alignment, room type
+and capacity, precedence, workload limits and building travel.
+
+Used by the /api/edit endpoints in api_service.py, which keep open
+editors in an EditorStore (idle timeout and LRU cap).
+"""
+
+from typing import List, Dict, Optional
+from collections import OrderedDict, defaultdict
+from dataclasses import dataclass
+import threading
+import time
+import uuid
+
+from verifier import ScheduleVerifier, DAY_NAMES, PERIODS_PER_DAY, day_index
+
+# ==================== DATA MODELS ====================
+
+@dataclass
+class EditSession:
+    """One placed session (all the per-section rows that share it)"""
+    course_id: str
+    session_type: str
+    sections: List[str]
+    instructor_id: str
+    room_id: str
+    day: int
+    period: int
+    duration: int
+    students_count: int
+    rows: List[Dict]  # Schedule entries updated in place on every move
+
+# ==================== EDITOR ====================
+
+class TimetableEditor:
+    def __init__(self, data: Dict, schedule: List[Dict]):
+        self.rules = ScheduleVerifier(data)
+        self.created_at = time.time()
+        self.last_used = self.created_at  # Refreshed by EditorStore.get
+        # Endpoints run in a threadpool: one check or move at a time per editor
+        self.lock = threading.RLock()
+
+        # Fold per-section rows into sessions, as the verifier does
+        self.sessions = []
+        self.session_by_instance = {}  # instance_id -> session index
+        self.session_by_section = {}  # (course_id, session_type, section_id) -> session index
+        index_by_key = {}
+        for entry in schedule:
+            day = day_index(entry['day'])
+            if day is None:
+                raise ValueError(f"{entry['course_id']} ({entry['type']}) has unknown day {entry['day']!r}")
+            key = (entry['course_id'], entry['type'], day, entry['start_period'],
+                   entry['duration_periods'], entry['instructor_id'], entry['room_id'])
+            idx = index_by_key.get(key)
+            if idx is None:
+                idx = len(self.sessions)
+                index_by_key[key] = idx
+                self.sessions.append(EditSession(
+                    course_id=entry['course_id'],
+                    session_type=entry['type'],
+                    sections=[],
+                    instructor_id=entry['instructor_id'],
+                    room_id=entry['room_id'],
+                    day=day,
+                    period=entry['start_period'] - 1,
+                    duration=entry['duration_periods'],
+                    students_count=0,
+                    rows=[]
+                ))
+            session = self.sessions[idx]
+            session.sections.append(entry['section_id'])
+            session.students_count += self.rules.sections[entry['section_id']]['students_count']
+            session.rows.append(entry)
+            self.session_by_instance[entry['instance_id']] = idx
+            self.session_by_section[(entry['course_id'], entry['type'], entry['section_id'])] = idx
+
+        # State
+        self.busy = {}  # (entity kind, entity id) -> bitset of busy slots
+        self.owner = {}  # (entity kind, entity id, slot) -> session index
+        self.session_counts = defaultdict(int)  # (entity kind, entity id) -> sessions (workload minimum days)
+
+        for idx in range(len(self.sessions)):
+            self._occupy(idx, True)
+            for entity in self._entities(self.sessions[idx], "N/A"):
+                self.session_counts[entity] += 1
+
+        self.score = sum(self._gaps(self.busy.get(entity, 0), day)
+                         for entity in self.busy if entity[0] in ('section', 'instructor')
+                         for day in range(len(DAY_NAMES)))
+
+    @staticmethod
+    def _mask(day: int, period: int, duration: int) -> int:
+        return ((1 << duration) - 1) << (day * PERIODS_PER_DAY + period)
+
+    @staticmethod
+    def _gaps(mask: int, day: int) -> int:
+        """Idle periods between the first and last busy period of one day"""
+        bits = (mask >> (day * PERIODS_PER_DAY)) & ((1 << PERIODS_PER_DAY) - 1)
+        if not bits:
+            return 0
+        first = (bits & -bits).bit_length() - 1
+        return bits.bit_length() - first - bits.bit_count()
+
+    def _entities(self, session: EditSession, room_id: str) -> List[tuple]:
+        entities = [('section', sid) for sid in session.sections]
+        clusters = {cluster for sid in session.sections
+                    for cluster in self.rules.clusters_by_enrollment.get((session.course_id, sid), ())}
+        entities += [('students', cluster) for cluster in sorted(clusters)]
+        if session.instructor_id != "N/A":
+            entities.append(('instructor', session.instructor_id))
+        if room_id != "N/A":
+            entities.append(('room', room_id))
+        return entities
+
+    def _occupy(self, idx: int, place: bool):
+        """Set or clear a session's slots in every entity bitset"""
+        session = self.sessions[idx]
+        mask = self._mask(session.day, session.period, session.duration)
+        first_slot = session.day * PERIODS_PER_DAY + session.period
+        for entity in self._entities(session, session.room_id):
+            if place:
+                self.busy[entity] = self.busy.get(entity, 0) | mask
+            else:
+                self.busy[entity] &= ~mask
+            for slot in range(first_slot, first_slot + session.duration):
+                if place:
+                    self.owner[entity + (slot,)] = idx
+                else:
+                    self.owner.pop(entity + (slot,), None)
+
+    # ==================== QUERIES ====================
+
+    def check_move(self, instance_id: str, day, start_period: int,
+                   room_id: Optional[str] = None) -> Dict:
+        """
+        Check moving the session containing instance_id to (day, start_period, room).
+        start_period is 1-based like the schedule entries; room_id defaults to the current room.
+        Returns the conflicting entities and the change in total idle periods (score_delta).
+        """
+        with self.lock:
+            return self._check_move(instance_id, day, start_period, room_id)
+
+    def _check_move(self, instance_id: str, day, start_period: int, room_id: Optional[str]) -> Dict:
+        idx = self.session_by_instance.get(instance_id)
+        if idx is None:
+            return {'valid': False, 'conflicts': [],
+                    'violations': [f"Unknown session instance {instance_id}"], 'score_delta': 0}
+
+        session = self.sessions[idx]
+        requested_day, day = day, day_index(day)
+        period = start_period - 1
+        room_id = room_id or session.room_id
+        violations = []
+
+        if day is None:
+            violations.append(f"Unknown day {requested_day!r}")
+        if period < 0 or period + session.duration > PERIODS_PER_DAY:
+            violations.append(f"{session.duration}-period session cannot start at period {start_period}")
+        elif session.duration == 2 and period % 2 != 0:
+            violations.append("90-minute sessions must start on an odd period")
+
+        if room_id != session.room_id:
+            room = self.rules.rooms.get(room_id)
+            kind = self.rules.kinds[(session.course_id, session.session_type)]
+            if room is None:
+                violations.append(f"Unknown room {room_id}")
+            else:
+                expected_types = self.rules._room_types(session.session_type, kind)
+                if room['type'] not in expected_types:
+                    violations.append(f"{room_id} is a {room['type']}, expected {' or '.join(expected_types)}")
+                if not kind.get('ignore_capacity', False) and room['capacity'] < session.students_count:
+                    violations.append(f"{room_id} holds {room['capacity']}, session has {session.students_count} students")
+
+        if violations:
+            return {'valid': False, 'conflicts': [], 'violations': violations, 'score_delta': 0}
+
+        old_mask = self._mask(session.day, session.period, session.duration)
+        new_mask = self._mask(day, period, session.duration)
+        first_slot = day * PERIODS_PER_DAY + period
+
+        # Conflicts: any busy bit not owned by the session itself
+        conflicts = []
+        for entity in self._entities(session, room_id):
+            busy = self.busy.get(entity, 0)
+            if entity[0] != 'room' or room_id == session.room_id:
+                busy &= ~old_mask
+            if not busy & new_mask:
+                continue
+            others = {self.owner[entity + (slot,)]
+                      for slot in range(first_slot, first_slot + session.duration)
+                      if busy >> slot & 1}
+            for other in sorted(others):
+                other_session = self.sessions[other]
+                conflicts.append({
+                    'entity_type': entity[0],
+                    'entity_id': entity[1],
+                    'course_id': other_session.course_id,
+                    'session_type': other_session.session_type,
+                    'instance_id': other_session.rows[0]['instance_id']
+                })
+
+        violations = self._rule_problems(idx, day, period, room_id, old_mask, new_mask)
+
+        # Soft score: idle periods of the moved session's sections and instructor
+        score_delta = 0
+        for entity in self._entities(session, "N/A"):
+            if entity[0] == 'students':
+                continue
+            busy = self.busy.get(entity, 0)
+            moved = (busy & ~old_mask) | new_mask
+            for d in {session.day, day}:
+                score_delta += self._gaps(moved, d) - self._gaps(busy, d)
+
+        return {'valid': not conflicts and not violations, 'conflicts': conflicts, 'violations': violations,
+                'score_delta': score_delta}
+
+    def _rule_problems(self, idx: int, day: int, period: int, room_id: str, old_mask: int, new_mask: int) -> List[str]:
+        """
+        Precedence, workload and building-travel rules (ScheduleVerifier's)
+        the move breaks. Problems the schedule already has with the session
+        where it is now are not reported again.
+        """
+        session = self.sessions[idx]
+        current = self._placement_problems(idx, session.day, session.period, session.room_id, old_mask, old_mask)
+        return [p for p in self._placement_problems(idx, day, period, room_id, old_mask, new_mask)
+                if p not in current]
+
+    def _placement_problems(self, idx: int, day: int, period: int, room_id: str,
+                            old_mask: int, new_mask: int) -> List[str]:
+        """Rule problems with the session at (day, period, room) and everything else where it is"""
+        session = self.sessions[idx]
+        rules = self.rules
+        problems = []
+
+        # Precedence: the session in either role, against each section's partner session
+        for before, after, gap, same_day in rules.precedence.get(session.course_id, ()):
+            for section_id in session.sections:
+                problem = None
+                if session.session_type == after:
+                    other = self.session_by_section.get((session.course_id, before, section_id))
+                    if other is not None and other != idx:
+                        o = self.sessions[other]
+                        problem = rules.precedence_problem(f"{session.course_id} ({after}) for {section_id}",
+                                                           (day, period), before, (o.day, o.period, o.duration),
+                                                           gap, same_day)
+                elif session.session_type == before:
+                    other = self.session_by_section.get((session.course_id, after, section_id))
+                    if other is not None and other != idx:
+                        o = self.sessions[other]
+                        problem = rules.precedence_problem(f"{session.course_id} ({after}) for {section_id}",
+                                                           (o.day, o.period), before, (day, period, session.duration),
+                                                           gap, same_day)
+                if problem and problem not in problems:
+                    problems.append(problem)
+
+        room = rules.rooms.get(room_id)
+        building = room['building'] if room else None
+        first_slot = day * PERIODS_PER_DAY + period
+        neighbours = [slot for slot, inside in ((first_slot - 1, period > 0),
+                                                (first_slot + session.duration,
+                                                 period + session.duration < PERIODS_PER_DAY)) if inside]
+        for entity in self._entities(session, "N/A"):
+            if entity[0] == 'students':
+                continue
+            name = entity[0].capitalize()
+            busy = self.busy.get(entity, 0) & ~old_mask
+
+            problems += rules.workload_problems(entity[0] + "s", name, entity[1], busy | new_mask,
+                                                self.session_counts[entity])
+
+            # Building travel: the periods right before and after the session
+            for slot in neighbours:
+                other = self.owner.get(entity + (slot,))
+                if other is None or other == idx or not busy >> slot & 1:
+                    continue
+                other_room = rules.rooms.get(self.sessions[other].room_id)
+                if other_room is None:
+                    continue
+                pair = (other_room['building'], building) if slot < first_slot else (building, other_room['building'])
+                if rules.travel_blocked(*pair):
+                    problems.append(f"{name} {entity[1]} goes between {pair[0]} and {pair[1]} with no break "
+                                    f"on {DAY_NAMES[day]} period {slot % PERIODS_PER_DAY + 1}")
+        return problems
+
+    # ==================== UPDATES ====================
+
+    def apply_move(self, instance_id: str, day, start_period: int,
+                   room_id: Optional[str] = None) -> Dict:
+        """Apply a move if it is valid, updating the state incrementally"""
+        with self.lock:
+            return self._apply_move(instance_id, day, start_period, room_id)
+
+    def _apply_move(self, instance_id: str, day, start_period: int, room_id: Optional[str]) -> Dict:
+        result = self._check_move(instance_id, day, start_period, room_id)
+        if not result['valid']:
+            result['applied'] = False
+            return result
+
+        idx = self.session_by_instance[instance_id]
+        session = self.sessions[idx]
+        self._occupy(idx, False)
+
+        session.day = day_index(day)
+        session.period = start_period - 1
+        session.room_id = room_id or session.room_id
+        self._occupy(idx, True)
+        self._update_rows(session)
+
+        self.score += result['score_delta']
+        result['applied'] = True
+        result['score'] = self.score
+        return result
+
+    def _update_rows(self, session: EditSession):
+        """Rewrite the session's schedule entries after a move"""
+        room = self.rules.rooms.get(session.room_id)
+        start_minutes = session.period * 45
+        end_minutes = start_minutes + session.duration * 45
+        time_slot = (f"{start_minutes // 60:02d}:{start_minutes % 60:02d} - "
+                     f"{end_minutes // 60:02d}:{end_minutes % 60:02d}")
+
+        for row in session.rows:
+            row.update({
+                'day': DAY_NAMES[session.day],
+                'period': session.period + 1,
+                'start_period': session.period + 1,
+                'end_period': session.period + session.duration,
+                'time_slot': time_slot,
+                'room_id': session.room_id,
+                'room_type': room['type'] if room else "N/A",
+                'building': room['building'] if room else "N/A",
+                'period_alignment': ("Even" if session.period % 2 == 0 else "Odd")
+                                    if session.duration == 2 else "Any"
+            })
+
+    def get_schedule(self) -> List[Dict]:
+        """Current schedule entries in the _extract_solution format"""
+        with self.lock:
+            return [dict(row) for session in self.sessions for row in session.rows]
+
+# ==================== EDITOR STORE ====================
+
+class EditorStore:
+    """
+    Open editors by edit session id, least recently used first. Editors
+    idle for longer than ttl_seconds are dropped on the next add or get,
+    and the least recently used go once more than max_sessions are open.
+    """
+    def __init__(self, ttl_seconds: float = 3600, max_sessions: int = 64):
+        self.ttl_seconds = ttl_seconds
+        self.max_sessions = max_sessions
+        self.editors = OrderedDict()  # edit_session_id -> TimetableEditor
+        self.lock = threading.Lock()
+
+    def __len__(self) -> int:
+        return len(self.editors)
+
+    def add(self, editor: TimetableEditor) -> str:
+        edit_session_id = uuid.uuid4().hex
+        with self.lock:
+            self._evict(time.time())
+            self.editors[edit_session_id] = editor
+            while len(self.editors) > self.max_sessions:
+                self.editors.popitem(last=False)
+        return edit_session_id
+
+    def get(self, edit_session_id: str) -> Optional[TimetableEditor]:
+        now = time.time()
+        with self.lock:
+            self._evict(now)
+            editor = self.editors.get(edit_session_id)
+            if editor is not None:
+                editor.last_used = now
+                self.editors.move_to_end(edit_session_id)
+            return editor
+
+    def remove(self, edit_session_id: str) -> bool:
+        with self.lock:
+            return self.editors.pop(edit_session_id, None) is not None
+
+    def _evict(self, now: float):
+        """Drop idle editors (the front of the order is the least recently used)"""
+        while self.editors:
+            edit_session_id, editor = next(iter(self.editors.items()))
+            if now - editor.last_used <= self.ttl_seconds:
+                break
+            del self.editors[edit_session_id]
@@ -0,0 +1,222 @@
+"""
+Priority scheduling and admission control for solve jobs
+Sits between the API endpoints and the solver process pool: jobs wait in
+a priority queue, each client may only run a few at once, jobs whose
+estimated cost does not fit the class budget are refused up front, and
+a running lower-priority solve is preempted (it stops at its next
+checkpoint and is requeued) when a higher-priority job has no worker.
+
+Used by api_service.py.
+"""
+
+from typing import Dict, List, Optional, Callable
+from dataclasses import dataclass, field
+from functools import partial
+import asyncio
+import heapq
+import itertools
+import time
+
+from scheduler import instance_features
+from selector import predict_solve_times
+
+# ==================== PRIORITY CLASSES ====================
+
+PRIORITY_INTERACTIVE = 0  # Repairs of an existing timetable (pinned/preferred assignments)
+PRIORITY_SOLVE = 1  # Single solves
+PRIORITY_BATCH = 2  # Alternatives, what-if runs
+
+PRIORITY_NAMES = {PRIORITY_INTERACTIVE: "interactive", PRIORITY_SOLVE: "solve", PRIORITY_BATCH: "batch"}
+
+# Estimated process-seconds of queued and running work each class may hold before new jobs are refused
+DEFAULT_QUEUE_BUDGETS = {PRIORITY_INTERACTIVE: 600.0, PRIORITY_SOLVE: 3600.0, PRIORITY_BATCH: 7200.0}
+
+class AdmissionError(Exception):
+    """Job refused: its priority class already holds its budget of estimated work"""
+
+# ==================== JOBS ====================
+
+@dataclass
+class SolveJob:
+    job_id: int
+    priority: int
+    client_id: str
+    estimated_seconds: float
+    fn: Callable  # Picklable pool function; called as fn(*args, **kwargs)
+    args: tuple
+    kwargs: Dict
+    preemptible: bool  # fn accepts preemption_slot and returns status 'preempted' when flagged
+    future: asyncio.Future
+    processes: int = 1  # Worker processes fn fans out to (alternatives); its cost is per process
+    submitted_at: float = field(default_factory=time.time)
+    started_at: Optional[float] = None
+    slot: Optional[int] = None  # Worker/preemption flag index while running
+    preemptions: int = 0
+
+def estimate_solve_seconds(data: Dict, strategy: str, max_time_seconds: float) -> float:
+    """Predicted solve time (selector model), capped by the job's time limit"""
+    predicted = predict_solve_times(instance_features(data))
+    if strategy not in predicted:
+        strategy = min(predicted, key=predicted.get)
+    return min(predicted[strategy], float(max_time_seconds))
+
+# ==================== QUEUE ====================
+
+class SolveJobQueue:
+    def __init__(self, executor, flags, workers: int, client_cap: int = 2,
+                 queue_budgets: Optional[Dict[int, float]] = None):
+        """
+        executor: process pool started with scheduler.init_preemption_flags(flags)
+        flags: RawArray('b', workers), one preemption flag per running slot
+        """
+        self.executor = executor
+        self.flags = flags
+        self.workers = workers
+        self.client_cap = client_cap
+        self.queue_budgets = queue_budgets or dict(DEFAULT_QUEUE_BUDGETS)
+
+        self.pending = []  # heap of (priority, job_id, job)
+        self.running = {}  # slot -> job
+        self.ids = itertools.count()
+        self.completed = 0
+        self.preempted = 0
+
+    def _client_jobs(self, client_id: str) -> int:
+        return sum(1 for job in self.running.values() if job.client_id == client_id)
+
+    def _queued_seconds(self, priority: int) -> float:
+        return sum(job.estimated_seconds * job.processes for _, _, job in self.pending if job.priority == priority)
+
+    def _committed_seconds(self, priority: int) -> float:
+        """Estimated work of the class still to do: queued jobs plus what running ones have left"""
+        now = time.time()
+        running = sum(max(job.estimated_seconds - (now - job.started_at), 0.0) * job.processes
+                      for job in self.running.values() if job.priority == priority)
+        return self._queued_seconds(priority) + running
+
+    def admit(self, priority: int, estimated_seconds: float, processes: int = 1):
+        """Raise AdmissionError if the job would not fit its class budget now"""
+        budget = self.queue_budgets.get(priority, float('inf'))
+        committed = self._committed_seconds(priority)
+        if committed + estimated_seconds * processes > budget:
+            raise AdmissionError(
+                f"{PRIORITY_NAMES[priority]} queue is full ({committed:.0f}s of estimated work "
+                f"queued or running, budget {budget:.0f}s)")
+
+    async def submit(self, priority: int, client_id: str, estimated_seconds: float, fn: Callable,
+                     *args, preemptible: bool = False, processes: int = 1, **kwargs) -> Dict:
+        """
+        Queue a job and wait for its result; raises AdmissionError if refused.
+        Cancelling the wait drops the job: out of the queue if it has not
+        started, stopped at its next checkpoint if it is running and preemptible.
+        """
+        self.admit(priority, estimated_seconds, processes)
+
+        job = SolveJob(
+            job_id=next(self.ids),
+            priority=priority,
+            client_id=client_id,
+            estimated_seconds=estimated_seconds,
+            fn=fn,
+            args=args,
+            kwargs=kwargs,
+            preemptible=preemptible,
+            future=asyncio.get_running_loop().create_future(),
+            processes=processes
+        )
+        heapq.heappush(self.pending, (priority, job.job_id, job))
+        self._dispatch()
+        try:
+            return await job.future
+        except asyncio.CancelledError:
+            self._cancel(job)
+            raise
+
+    def _cancel(self, job: SolveJob):
+        """The caller went away: forget the job, or stop it if it is running"""
+        if any(queued is job for _, _, queued in self.pending):
+            self.pending = [entry for entry in self.pending if entry[2] is not job]
+            heapq.heapify(self.pending)
+        elif job.slot is not None and job.preemptible:
+            self.flags[job.slot] = 1  # _finished frees the slot when it stops
+
+    def _dispatch(self):
+        """Start queued jobs on free slots, best priority first, skipping clients at their cap"""
+        deferred = []
+        while self.pending and len(self.running) < self.workers:
+            entry = heapq.heappop(self.pending)
+            job = entry[2]
+            if job.future.done():
+                continue  # Cancelled while queued
+            if self._client_jobs(job.client_id) >= self.client_cap:
+                deferred.append(entry)
+                continue
+            self._start(job)
+        for entry in deferred:
+            heapq.heappush(self.pending, entry)
+
+        # Pool full: make room for the best waiting job by preempting the worst running one
+        if self.pending and len(self.running) >= self.workers:
+            waiting = next((job for _, _, job in sorted(self.pending)
+                            if self._client_jobs(job.client_id) < self.client_cap), None)
+            victims = [job for job in self.running.values()
+                       if waiting is not None and job.preemptible and job.priority > waiting.priority
+                       and not self.flags[job.slot]]
+            if victims:
+                victim = max(victims, key=lambda job: (job.priority, job.started_at))
+                self.flags[victim.slot] = 1
+                print(f"Preempting job {victim.job_id} ({PRIORITY_NAMES[victim.priority]}) "
+                      f"for job {waiting.job_id} ({PRIORITY_NAMES[waiting.priority]})")
+
+    def _start(self, job: SolveJob):
+        job.slot = next(slot for slot in range(self.workers) if slot not in self.running)
+        job.started_at = time.time()
+        self.flags[job.slot] = 0
+        self.running[job.slot] = job
+
+        kwargs = dict(job.kwargs)
+        if job.preemptible:
+            kwargs['preemption_slot'] = job.slot
+        task = asyncio.get_running_loop().run_in_executor(self.executor, partial(job.fn, *job.args, **kwargs))
+        task.add_done_callback(partial(self._finished, job))
+
+    def _finished(self, job: SolveJob, task: asyncio.Future):
+        del self.running[job.slot]
+        self.flags[job.slot] = 0
+        job.slot = None
+
+        if job.future.done():
+            pass  # Caller went away (request cancelled): drop the result, never requeue
+        elif task.exception() is not None:
+            job.future.set_exception(task.exception())
+        elif isinstance(task.result(), dict) and task.result().get('status') == 'preempted':
+            # Requeue with its original place in line
+            job.preemptions += 1
+            self.preempted += 1
+            heapq.heappush(self.pending, (job.priority, job.job_id, job))
+        else:
+            result = task.result()
+            if isinstance(result, dict):
+                result['job'] = {
+                    'job_id': job.job_id,
+                    'priority': PRIORITY_NAMES[job.priority],
+                    'estimated_seconds': job.estimated_seconds,
+                    'queued_seconds': job.started_at - job.submitted_at,
+                    'preemptions': job.preemptions
+                }
+            self.completed += 1
+            job.future.set_result(result)
+
+        self._dispatch()
+
+    def stats(self) -> Dict:
+        return {
+            'workers': self.workers,
+            'running': [{'job_id': job.job_id, 'priority': PRIORITY_NAMES[job.priority], 'client_id': job.client_id,
+                         'running_seconds': time.time() - job.started_at} for job in self.running.values()],
+            'queued': {PRIORITY_NAMES[p]: sum(1 for q, _, _ in self.pending if q == p) for p in PRIORITY_NAMES},
+            'queued_seconds': {PRIORITY_NAMES[p]: self._queued_seconds(p) for p in PRIORITY_NAMES},
+            'committed_seconds': {PRIORITY_NAMES[p]: self._committed_seconds(p) for p in PRIORITY_NAMES},
+            'completed': self.completed,
+            'preempted': self.preempted
+        }
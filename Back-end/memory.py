@@ -0,0 +1,130 @@
+"""
+Memory accounting and budgets for solves
+Samples the process's resident set at every search checkpoint (current
+and peak; the peak is also reported as growth over the baseline taken when
+the solve started, since pool workers carry what earlier solves left),
+sizes the scheduler's large structures on demand (per-structure
+breakdown) and decides when a solve has to give something up to stay
+inside its budget: learned nogoods first, then worker processes, then
+the search itself (the solve returns what it has as 'partial').
+
+Budgets come from data['memory_budget_mb'] or SCHEDULER_MEMORY_BUDGET_MB
+and cover the solving process; pool workers are sized against what is
+left of it.
+"""
+
+from typing import Dict, Optional, Callable
+from array import array
+import os
+import resource
+import sys
+
+PAGE_SIZE = os.sysconf("SC_PAGE_SIZE") if hasattr(os, "sysconf") else 4096
+MB = 1 << 20
+
+def current_rss() -> int:
+    """Resident set size of this process in bytes"""
+    try:
+        with open("/proc/self/statm") as f:
+            return int(f.read().split()[1]) * PAGE_SIZE
+    except (OSError, IndexError, ValueError):
+        return process_peak_rss()  # No procfs: the peak is the best bound available
+
+def process_peak_rss() -> int:
+    """Peak resident set size over the process lifetime in bytes (pool workers outlive solves)"""
+    peak = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    return peak if sys.platform == "darwin" else peak * 1024
+
+def deep_size(obj, seen: Optional[set] = None) -> int:
+    """Approximate bytes held by obj and everything it references (shared objects counted once)"""
+    seen = set() if seen is None else seen
+    total = 0
+    stack = [obj]
+    while stack:
+        item = stack.pop()
+        if id(item) in seen:
+            continue
+        seen.add(id(item))
+        total += sys.getsizeof(item)
+        if isinstance(item, dict):
+            stack.extend(item.keys())
+            stack.extend(item.values())
+        elif isinstance(item, (list, tuple, set, frozenset)):
+            stack.extend(item)
+        elif isinstance(item, (str, bytes, int, float, array)):
+            pass
+        elif hasattr(item, "__dict__"):
+            stack.append(vars(item))
+    return total
+
+def budget_from(data: Dict) -> Optional[int]:
+    """Budget in bytes from the request, else the environment, else None (unlimited)"""
+    budget_mb = data.get('memory_budget_mb', os.environ.get("SCHEDULER_MEMORY_BUDGET_MB"))
+    return int(float(budget_mb) * MB) if budget_mb else None
+
+# ==================== ACCOUNT ====================
+
+class MemoryAccount:
+    def __init__(self, budget: Optional[int] = None):
+        self.budget = budget  # bytes, None for unlimited
+        self.baseline = current_rss()
+        self.current = self.baseline
+        self.peak = self.baseline
+        self.structures = {}  # name -> getter returning the structure to size
+        self.degradations = []  # what was given up to stay in budget, in order
+
+    def track(self, name: str, getter: Callable):
+        self.structures[name] = getter
+
+    def sample(self) -> int:
+        """Read the resident set now; keeps the peak"""
+        self.current = current_rss()
+        if self.current > self.peak:
+            self.peak = self.current
+        return self.current
+
+    def over_budget(self) -> bool:
+        """Sample (with or without a budget, so the peak is always tracked) and compare"""
+        self.sample()
+        return self.budget is not None and self.current > self.budget
+
+    def peak_growth_mb(self) -> float:
+        """Peak over the baseline, in MB"""
+        return round((self.peak - self.baseline) / MB, 1)
+
+    def degrade(self, step: str):
+        self.degradations.append({'step': step, 'rss_mb': round(self.current / MB, 1)})
+        print(f"Memory {self.current / MB:.0f}MB over budget {self.budget / MB:.0f}MB: {step}")
+
+    def workers_within_budget(self, workers: int) -> int:
+        """
+        Worker processes that fit in the remaining budget, assuming each
+        grows to this process's size (forked pages get copied as the
+        interpreter touches them)
+        """
+        if self.budget is None:
+            return workers
+        per_worker = max(self.sample(), 1)
+        fitting = max(1, (self.budget - self.current) // per_worker)
+        if fitting < workers:
+            self.degrade(f"workers reduced from {workers} to {fitting}")
+            return fitting
+        return workers
+
+    def breakdown(self) -> Dict[str, float]:
+        """MB per tracked structure (sized now; references shared between structures count once)"""
+        seen = set()
+        return {name: round(deep_size(getter(), seen) / MB, 3) for name, getter in self.structures.items()}
+
+    def report(self) -> Dict:
+        self.sample()
+        return {
+            'current_mb': round(self.current / MB, 1),
+            'peak_mb': round(self.peak / MB, 1),
+            'peak_delta_mb': self.peak_growth_mb(),
+            'baseline_mb': round(self.baseline / MB, 1),
+            'process_peak_mb': round(process_peak_rss() / MB, 1),
+            'budget_mb': round(self.budget / MB, 1) if self.budget is not None else None,
+            'structures_mb': self.breakdown(),
+            'degradations': self.degradations
+        }
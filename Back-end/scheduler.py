@@ -9,12 +9,22 @@ Usage:
 python backtracking_scheduler.py
 """
 
-from typing import List, Dict, Set, Tuple, Optional
-from dataclasses import dataclass
+from typing import List, Dict, Set, Tuple, Optional, Iterable
+from dataclasses import dataclass, field
 from collections import defaultdict
+from functools import partial
+from array import array
 import json
 import time
 import copy
+import random
+import math
+import itertools
+
+from verifier import verify_schedule, precedence_rules, workload_limits, building_travel, LONGEST_RUN
+from selector import select_strategy
+from tracing import span, start_trace, stop_trace
+from memory import MemoryAccount, budget_from, MB
 
 # ==================== DATA MODELS ====================
 
@@ -74,67 +84,452 @@ class Assignment:
     sections: List[str]
     duration: int
     instructor_id: str
-    room_id: str
+    room_id: Optional[str]  # None until the room pool binds it (lazy room binding)
+    session_id: int = -1  # Compiled session this assignment places (-1 if none)
+
+@dataclass
+class CompiledSession:
+    """One (course, kind, section group) that must be placed exactly once"""
+    session_id: int
+    course: Course
+    kind: CourseKind
+    sections: List[str]
+    section_indices: List[int]
+    students_count: int
+    duration: int  # in periods
+    days: List[int]  # day values in try order
+    periods: List[int]  # period values in try order
+    instructors: List[str]
+    rooms: List[str]
+    cluster_indices: List[int] = field(default_factory=list)  # Student clusters attending
+
+class SearchTimeout(Exception):
+    """Raised inside the search when the deadline passes"""
+
+class SearchStopped(SearchTimeout):
+    """Raised inside an enumeration when other workers already found enough solutions"""
+
+class SearchMemoryExceeded(Exception):
+    """Raised at a checkpoint when the solve is over its memory budget with nothing left to give up"""
+
+class SearchPreempted(Exception):
+    """Raised at a checkpoint when the job queue wants the worker back (see job_queue.py)"""
+
+# Per pool process: shared preemption flags, one per job slot (set by init_preemption_flags)
+_preemption_flags = None
+
+def init_preemption_flags(flags):
+    """Pool initializer: flags is a RawArray('b') written by the job queue"""
+    global _preemption_flags
+    _preemption_flags = flags
+
+# ==================== RESULT COLUMNS ====================
+
+class ScheduleColumns:
+    """
+    A solved schedule as parallel typed arrays, one element per
+    (session, section) row. Ids are stored as indexes into small string
+    tables, so the whole result pickles as a handful of buffers instead
+    of hundreds of 24-key dicts. Rows in the _extract_solution format are
+    built on demand by to_rows().
+    """
+    DAY_NAMES = ["Sunday", "Monday", "Tuesday", "Wednesday", "Thursday"]
+
+    def __init__(self, course_ids: List[str], session_types: List[str], section_ids: List[str],
+                 instructor_ids: List[str], room_ids: List[str]):
+        # String tables
+        self.course_ids = course_ids
+        self.session_types = session_types
+        self.section_ids = section_ids
+        self.instructor_ids = instructor_ids
+        self.room_ids = room_ids
+
+        # Columns (buffer protocol: memoryview(columns.day) etc.)
+        self.course = array('H')
+        self.session_type = array('B')
+        self.section = array('H')
+        self.instructor = array('H')
+        self.room = array('H')
+        self.day = array('B')
+        self.period = array('B')  # Slot the row was found at (0-based)
+        self.start_period = array('B')  # 0-based
+        self.duration = array('B')
+
+    def __len__(self) -> int:
+        return len(self.section)
+
+    def append(self, course: int, session_type: int, section: int, instructor: int, room: int,
+               day: int, period: int, start_period: int, duration: int):
+        self.course.append(course)
+        self.session_type.append(session_type)
+        self.section.append(section)
+        self.instructor.append(instructor)
+        self.room.append(room)
+        self.day.append(day)
+        self.period.append(period)
+        self.start_period.append(start_period)
+        self.duration.append(duration)
+
+    def iter_entries(self):
+        """Minimal rows (the keys the verifier reads), one at a time"""
+        for i in range(len(self.section)):
+            yield {
+                'course_id': self.course_ids[self.course[i]],
+                'type': self.session_types[self.session_type[i]],
+                'day': self.day[i],
+                'start_period': self.start_period[i] + 1,
+                'duration_periods': self.duration[i],
+                'instructor_id': self.instructor_ids[self.instructor[i]],
+                'room_id': self.room_ids[self.room[i]],
+                'section_id': self.section_ids[self.section[i]]
+            }
+
+    def to_lists(self) -> Dict:
+        """JSON-ready columns and string tables, without building rows"""
+        return {
+            'tables': {
+                'course_ids': self.course_ids,
+                'session_types': self.session_types,
+                'section_ids': self.section_ids,
+                'instructor_ids': self.instructor_ids,
+                'room_ids': self.room_ids
+            },
+            'columns': {
+                name: getattr(self, name).tolist()
+                for name in ('course', 'session_type', 'section', 'instructor', 'room',
+                             'day', 'period', 'start_period', 'duration')
+            }
+        }
+
+    def to_rows(self, data: Dict) -> List[Dict]:
+        """Full schedule entries in the _extract_solution format"""
+        course_by_id = {c['course_id']: c for c in data['courses']}
+        room_by_id = {r['room_id']: r for r in data['rooms']}
+        instructor_by_id = {i['instr_id']: i for i in data['instructors']}
+        section_by_id = {s['section_id']: s for s in data['sections']}
+        group_by_id = {g['group_id']: g for g in data['groups']}
+
+        schedule = []
+        for i in range(len(self.section)):
+            course_id = self.course_ids[self.course[i]]
+            session_type = self.session_types[self.session_type[i]]
+            section_id = self.section_ids[self.section[i]]
+            instructor_id = self.instructor_ids[self.instructor[i]]
+            room_id = self.room_ids[self.room[i]]
+            day, period, start, duration = self.day[i], self.period[i], self.start_period[i], self.duration[i]
+
+            section = section_by_id[section_id]
+            group = group_by_id[section['group_id']]
+            course = course_by_id[course_id]
+            room = room_by_id.get(room_id, None)
+            instructor = instructor_by_id.get(instructor_id, None)
+
+            # Calculate time slot
+            start_time_minutes = start * 45
+            end_time_minutes = start_time_minutes + (duration * 45)
+
+            start_hour = start_time_minutes // 60
+            start_minute = start_time_minutes % 60
+            end_hour = end_time_minutes // 60
+            end_minute = end_time_minutes % 60
+
+            time_slot = f"{start_hour:02d}:{start_minute:02d} - {end_hour:02d}:{end_minute:02d}"
+
+            # Determine period alignment
+            period_alignment = "Any"
+            if duration == 2:
+                period_alignment = "Even" if start % 2 == 0 else "Odd"
+
+            # Determine section display
+            section_display = section_id.split('-')[-1]
+
+            # Determine lab type and physics lab status
+            lab_type = None
+            is_physics_lab = False
+            if session_type == "Lab":
+                # Find the course kind to get lab_type
+                for kind in course['kinds']:
+                    if kind['type'] == "Lab":
+                        lab_type = kind.get('lab_type')
+                        is_physics_lab = (lab_type == "physics lab")
+                        break
+
+            schedule.append({
+                'instance_id': f"{course_id}_{section_id}_{session_type.upper()}",
+                'course_id': course_id,
+                'course_name': course['name'],
+                'type': session_type,
+                'meeting_type': session_type,
+                'day': self.DAY_NAMES[day],
+                'period': period + 1,  # Convert to 1-based
+                'start_period': start + 1,  # Convert to 1-based
+                'end_period': start + duration,  # Already 1-based
+                'time_slot': time_slot,
+                'duration_periods': duration,
+                'duration_minutes': duration * 45,
+                'room_id': room_id,
+                'room_type': room['type'] if room else "N/A",
+                'building': room['building'] if room else "N/A",
+                'instructor_id': instructor_id,
+                'instructor_name': instructor['name'] if instructor else "N/A",
+                'group_id': section['group_id'],
+                'section_id': section_id,
+                'section_display': section_display,
+                'year': group['year'],
+                'lab_type': lab_type,
+                'is_physics_lab': is_physics_lab,
+                'period_alignment': period_alignment
+            })
+
+        return schedule
+
+# ==================== ROOM POOL ====================
+
+class RoomPool:
+    """
+    Lazy room binding for the course search. Rooms of one (type, capacity)
+    bucket are interchangeable, so the search keeps per slot only the free
+    rooms of each bucket (rooms held by concretely placed sessions taken
+    out) and how many unbound sessions sit there per bucket mask. A
+    session fits a slot when Hall's condition still holds for every union
+    of bucket masks overlapping its own; concrete rooms are bound once the
+    timetable is complete (BacktrackingScheduler._bind_rooms).
+    """
+
+    def __init__(self, rooms: List[Room], total_slots: int):
+        buckets = {}
+        for room in rooms:
+            buckets.setdefault((room.type, room.capacity), []).append(room.room_id)
+        self.bucket_rooms = list(buckets.values())
+        self.bucket_of_room = {room_id: b for b, room_ids in enumerate(self.bucket_rooms) for room_id in room_ids}
+        self.free = [[len(room_ids) for room_ids in self.bucket_rooms] for _ in range(total_slots)]
+        self.demand = [{} for _ in range(total_slots)]  # slot -> bucket mask -> unbound sessions
+        self.unbound = [0] * total_slots  # slot -> unbound sessions
+        self.mask_buckets = {}  # bucket mask -> bucket indices
+        self.session_masks = []  # session id -> bucket mask (0: rooms bound eagerly)
+        self.bind_order = []  # session id -> rooms to bind, smallest first (preferred room leads)
+
+    def mask_of(self, room_ids: List[str]) -> int:
+        """Bucket mask when room_ids is exactly a union of buckets, else 0"""
+        if not room_ids or any(room_id not in self.bucket_of_room for room_id in room_ids):
+            return 0
+        mask = 0
+        for room_id in room_ids:
+            mask |= 1 << self.bucket_of_room[room_id]
+        if sum(len(self.bucket_rooms[b]) for b in self._buckets(mask)) != len(set(room_ids)):
+            return 0
+        return mask
+
+    def _buckets(self, mask: int) -> List[int]:
+        buckets = self.mask_buckets.get(mask)
+        if buckets is None:
+            buckets = self.mask_buckets[mask] = [b for b in range(len(self.bucket_rooms)) if mask >> b & 1]
+        return buckets
+
+    def admits(self, mask: int, first_slot: int, duration: int) -> bool:
+        """Whether one more session on mask keeps a room for everyone in each slot it covers"""
+        for slot in range(first_slot, first_slot + duration):
+            free = self.free[slot]
+            supply = sum(free[b] for b in self._buckets(mask))
+            if not supply:
+                return False
+            # Everyone unbound here fits in this session's own buckets
+            if self.unbound[slot] < supply:
+                continue
+            if not self._hall(slot, mask):
+                return False
+        return True
+
+    def _hall(self, slot: int, mask: int) -> bool:
+        """
+        Hall's condition at slot with one more session on mask. Only unions
+        containing mask can have become violated, and unions that do not
+        overlap a mask gain nothing from it, so unions are grown from mask
+        through overlapping masks (a handful: capacity buckets nest).
+        """
+        demand = self.demand[slot]
+        free = self.free[slot]
+        unions = {mask}
+        grown = True
+        while grown:
+            grown = False
+            for other in demand:
+                for union in list(unions):
+                    if union & other and union | other not in unions:
+                        unions.add(union | other)
+                        grown = True
+        for union in unions:
+            needed = 1 + sum(count for other, count in demand.items() if not other & ~union)
+            if needed > sum(free[b] for b in self._buckets(union)):
+                return False
+        return True
+
+    def place(self, mask: int, first_slot: int, duration: int):
+        for slot in range(first_slot, first_slot + duration):
+            demand = self.demand[slot]
+            demand[mask] = demand.get(mask, 0) + 1
+            self.unbound[slot] += 1
+
+    def unplace(self, mask: int, first_slot: int, duration: int):
+        for slot in range(first_slot, first_slot + duration):
+            demand = self.demand[slot]
+            if demand[mask] > 1:
+                demand[mask] -= 1
+            else:
+                del demand[mask]
+            self.unbound[slot] -= 1
+
+    def take(self, room_id: str, first_slot: int, duration: int):
+        bucket = self.bucket_of_room.get(room_id)
+        if bucket is not None:
+            for slot in range(first_slot, first_slot + duration):
+                self.free[slot][bucket] -= 1
+
+    def release(self, room_id: str, first_slot: int, duration: int):
+        bucket = self.bucket_of_room.get(room_id)
+        if bucket is not None:
+            for slot in range(first_slot, first_slot + duration):
+                self.free[slot][bucket] += 1
 
 # ==================== BACKTRACKING SCHEDULER ====================
 
 class BacktrackingScheduler:
     def __init__(self, data: Dict):
         self.data = data
+        # Memory accounting and budget (memory.py); the baseline is taken before parsing
+        self.memory = MemoryAccount(budget_from(data))
 
         # Parse data
-        self.rooms = [Room(**r) for r in data['rooms']]
-        self.instructors = [Instructor(**i) for i in data['instructors']]
-        self.groups = [Group(**g) for g in data['groups']]
-        self.sections = [Section(**s) for s in data['sections']]
-        self.courses = []
-
-        # Parse courses with new fields
-        for c in data['courses']:
-            kinds = []
-            for k in c['kinds']:
-                kinds.append(CourseKind(
-                    type=k['type'],
-                    length=k['length'],
-                    lab_type=k.get('lab_type'),
-                    max_sections_together=k.get('max_sections_together', 1),
-                    ignore_capacity=k.get('ignore_capacity', False)
+        with span("parse_input"):
+            self.rooms = [Room(**r) for r in data['rooms']]
+            self.instructors = [Instructor(**i) for i in data['instructors']]
+            self.groups = [Group(**g) for g in data['groups']]
+            self.sections = [Section(**s) for s in data['sections']]
+            self.courses = []
+
+            # Parse courses with new fields
+            for c in data['courses']:
+                kinds = []
+                for k in c['kinds']:
+                    kinds.append(CourseKind(
+                        type=k['type'],
+                        length=k['length'],
+                        lab_type=k.get('lab_type'),
+                        max_sections_together=k.get('max_sections_together', 1),
+                        ignore_capacity=k.get('ignore_capacity', False)
+                    ))
+
+                self.courses.append(Course(
+                    course_id=c['course_id'],
+                    name=c['name'],
+                    year=c['year'],
+                    major=c.get('major'),
+                    kinds=kinds,
+                    full_year=c.get('full_year', False),
+                    is_project=c.get('is_project', False)
                 ))
 
-            self.courses.append(Course(
-                course_id=c['course_id'],
-                name=c['name'],
-                year=c['year'],
-                major=c.get('major'),
-                kinds=kinds,
-                full_year=c.get('full_year', False),
-                is_project=c.get('is_project', False)
-            ))
-
         # Constants
         self.DAYS = 5
         self.PERIODS_PER_DAY = 8
         self.TOTAL_SLOTS = self.DAYS * self.PERIODS_PER_DAY
+        self.DAY_NAMES = ["Sunday", "Monday", "Tuesday", "Wednesday", "Thursday"]
 
         # Build indexes
-        self._build_indexes()
+        with span("build_indexes"):
+            self._build_indexes()
+        with span("compile_sessions"):
+            self._compile_sessions()
 
         # State
         self.timetable = {}  # (section_id, day, period) -> Assignment
-        self.instructor_busy = set()  # (instructor_id, day, period)
-        self.room_busy = set()  # (room_id, day, period)
-        self.scheduled_sessions = defaultdict(set)  # section_id -> set of (course_id, session_type)
+        self.section_busy = [0] * len(self.sections)  # section index -> bitset of busy slots
+        self.slot_section_busy = [0] * self.TOTAL_SLOTS  # slot -> bitset of busy section indices (transposed)
+        self.instructor_busy = {}  # instructor_id -> bitset of busy slots
+        self.room_busy = {}  # room_id -> bitset of busy slots
+        self.room_pool = None  # RoomPool when rooms are bound lazily (course strategy)
+        self.scheduled_masks = [0] * len(self.sections)  # section index -> bitset of placed session ids
+        self.placed_sessions = 0  # bit i set when compiled session i is placed
+        self.preferred_slots = {}  # session_id -> (day, period) from preferred_assignments
+        self.hint_warnings = []  # Preferred assignments not applied (section sets that do not match)
+        self.pinned_count = 0
+        self.cluster_busy = []  # student cluster index -> bitset of busy slots
+        self.cluster_sizes = []  # student cluster index -> number of students
+
+        # Enumeration state (enumerate_solutions)
+        self.enumerating = False
+        self.solutions = []  # slot vectors (session_id -> day * PERIODS_PER_DAY + period, -1 if unplaced)
+        self.solution_agree = []  # per recorded solution: placed sessions sitting in the same slot
+        self.max_agree = 0  # agreements allowed with any recorded solution
+        self.solution_target = 0
+        self.solution_results = []
+        self.own_solutions = []  # slot vectors this scheduler found (self.solutions also holds imported ones)
+
+        # Sharing with parallel enumeration workers (schedule_alternatives)
+        self.exchange = None  # WorkerExchange
+        self.worker = 0
+        self.exchange_seen = []  # per worker lane: solutions already imported
+        self.forbidden_starts = {}  # session_id -> bitset of start slots proven infeasible
+        self.precedence_links = {}  # session_id -> [(other session, other follows, min gap days, same day)]
+        self.precedence_blocked = {}  # session_id -> bitset of start slots placed linked sessions rule out
+
+        # Daily workload limits: (max periods per day, max consecutive periods, min days per week), None if unset
+        limits = workload_limits(data)
+        self.section_limits = limits.get('sections')
+        self.instructor_limits = limits.get('instructors')
+        self.section_day_periods = [[0] * self.DAYS for _ in self.sections]  # section index -> periods per day
+        self.instructor_day_periods = {}  # instructor_id -> periods per day
+        self.section_min_days = [0] * len(self.sections)  # section index -> days it must reach
+        self.section_session_masks = [0] * len(self.sections)  # section index -> bitset of its session ids
+        self.instructor_sessions = {}  # instructor_id -> sessions placed with them
+        self.instructor_session_masks = {}  # instructor_id -> bitset of the session ids they may teach
+
+        # Building travel: (mode, max distance, distance fn) or None, compiled by _compile_travel
+        self.travel = building_travel(data)
+        self.travel_hard = self.travel is not None and self.travel[0] == "hard"
+        self.travel_costs = []  # building * building_count + building -> cost class (hard: 1 if forbidden)
+        self.building_count = 0
+        self.room_building = {}  # room_id -> building index
+        self.section_slot_building = []  # section index -> building index per slot (-1 when free or roomless)
+        self.instructor_slot_building = {}  # instructor_id -> building index per slot
+        self.travel_penalty = 0  # Soft mode: distance of every back-to-back move in the current state
+        if self.travel is not None:
+            self._compile_travel()
+        self.root_placed = 0  # sessions placed before the search (pins)
+        self.preemption_slot = None  # Index into _preemption_flags polled at checkpoints
+
+        self.deadline = None
+        self.start_time = time.time()
+        self.day_stats = []  # solve_by_day: per round, per day subproblem stats
+        self.anchor_stats = []  # _solve_with_anchors: one entry per anchor placement tried
+        self.preferred_claims = {}  # _iter_anchor_placements: slots held by preferred non-anchor sessions
+        self.ga_stats = {}  # solve_by_ga: per island throughput and best fitness
+        self.instance_features = {}  # instance_features of the solved instance (set by solve for "auto")
+        self.strategy_selection = None  # strategy="auto": chosen strategy and predictions
 
         # Statistics
         self.attempts = 0
         self.backtracks = 0
 
+        # Structures sized in the memory report
+        self.memory.track('compiled_sessions', lambda: self.compiled_sessions)
+        self.memory.track('timetable', lambda: self.timetable)
+        self.memory.track('occupancy', lambda: (self.section_busy, self.instructor_busy, self.room_busy,
+                                                self.cluster_busy, self.scheduled_masks))
+        self.memory.track('solutions', lambda: (self.solutions, self.solution_results))
+        self.memory.track('nogoods', lambda: self.forbidden_starts)
+        self.keep_nogoods = True  # Cleared when the budget forces learned nogoods out
+        self.partial_columns = None  # Placed sessions when the budget stopped the search
+        self.partial_unplaced = 0
+        self.search_exhausted = False  # Set by _solve_with_anchors when a failure proves infeasibility
+
     def _build_indexes(self):
         """Build lookup indexes"""
         self.room_by_id = {r.room_id: r for r in self.rooms}
         self.instructor_by_id = {i.instr_id: i for i in self.instructors}
         self.group_by_id = {g.group_id: g for g in self.groups}
         self.section_by_id = {s.section_id: s for s in self.sections}
+        self.section_index = {s.section_id: i for i, s in enumerate(self.sections)}
         self.course_by_id = {c.course_id: c for c in self.courses}
 
         # Group/year mappings
@@ -150,6 +545,124 @@ class BacktrackingScheduler:
             for section in self.sections_by_group[group.group_id]:
                 self.sections_by_year[group.year].append(section)
 
+    def _compile_sessions(self):
+        """
+        Number every session the section strategy has to place and build one
+        queue of session ids per section. A session shared by several sections
+        is queued only for the first of them: sections are solved in order, so
+        later sections always find it placed already.
+        """
+        self.compiled_sessions = []
+        self.session_id_by_key = {}  # (course_id, session_type, sections) -> session id
+        self.session_id_by_section = {}  # (course_id, session_type, section_id) -> session id
+        self.section_queues = []  # section index -> [session id, ...]
+        self.section_required_masks = [0] * len(self.sections)  # section index -> bitset of session ids it attends
+        self.course_masks = defaultdict(int)  # course_id -> bitset of its session ids
+        self.lab_groups = {}  # (course_id, kind) -> lab partition of its sections
+        self.hinted_lab_groups = self._lab_groups_from_hints()  # course_id -> lab groups of a warm start
+
+        # Hot session data as parallel columns indexed by session id (structure
+        # of arrays): the conflict check reads these instead of walking the
+        # CompiledSession/Course/CourseKind objects. List columns share the
+        # CompiledSession's own lists, so later appends show up in both.
+        self.session_durations = array('b')
+        self.session_section_masks = []  # bitset of attending section indices
+        self.session_clusters = []  # attending student cluster indices
+        self.session_instructors = []  # candidate instructor ids
+        self.session_rooms = []  # candidate room ids
+        self.session_slot = array('b')  # start slot while placed, -1 otherwise
+        # Cold columns (reporting only)
+        self.session_course_ids = []
+        self.session_types = []
+        self.session_lab_types = []
+
+        owned = set()
+        for section in self.sections:
+            group = self.group_by_id[section.group_id]
+            queue = []
+
+            for course in self.courses:
+                if course.year != group.year:
+                    continue
+                if course.major is not None and course.major != group.specialization:
+                    continue
+                if course.is_project:
+                    continue
+
+                seen_types = set()
+                for kind in course.kinds:
+                    # Two kinds of the same type count as one session for a section
+                    if kind.type in seen_types:
+                        continue
+
+                    target_sections = next(
+                        (group_sections for group_sections in self._get_target_sections(course, kind, section)
+                         if section.section_id in group_sections),
+                        None
+                    )
+                    if not target_sections:
+                        continue
+                    seen_types.add(kind.type)
+
+                    session_id = self._get_session_id(course, kind, target_sections)
+                    if session_id not in owned:
+                        owned.add(session_id)
+                        queue.append(session_id)
+
+            self.section_queues.append(queue)
+
+    def _get_session_id(self, course: Course, kind: CourseKind, target_sections: List[str]) -> int:
+        """Return the compiled session id for this section group, creating it if needed"""
+        key = (course.course_id, kind.type, tuple(target_sections))
+        session_id = self.session_id_by_key.get(key)
+        if session_id is not None:
+            return session_id
+
+        students_count = sum(self.section_by_id[sid].students_count for sid in target_sections)
+        instructors = self._get_qualified_instructors(course.course_id, kind.type)
+        if course.is_project:
+            # Graduation projects need no room; supervisors are optional
+            rooms = ["N/A"]
+            instructors = instructors or ["N/A"]
+        else:
+            rooms = self._get_suitable_rooms(kind.type, students_count, kind.lab_type, kind.ignore_capacity)
+
+        session_id = len(self.compiled_sessions)
+        section_indices = [self.section_index[sid] for sid in target_sections]
+        session = CompiledSession(
+            session_id=session_id,
+            course=course,
+            kind=kind,
+            sections=target_sections,
+            section_indices=section_indices,
+            students_count=students_count,
+            duration=kind.length // 45,
+            days=list(range(self.DAYS)),
+            periods=list(range(self.PERIODS_PER_DAY)),
+            instructors=instructors,
+            rooms=rooms
+        )
+        self.compiled_sessions.append(session)
+        self.session_id_by_key[key] = session_id
+
+        self.session_durations.append(session.duration)
+        self.session_section_masks.append(sum(1 << idx for idx in set(section_indices)))
+        self.session_clusters.append(session.cluster_indices)
+        self.session_instructors.append(instructors)
+        self.session_rooms.append(rooms)
+        self.session_slot.append(-1)
+        self.session_course_ids.append(course.course_id)
+        self.session_types.append(kind.type)
+        self.session_lab_types.append(kind.lab_type)
+
+        bit = 1 << session_id
+        self.course_masks[course.course_id] |= bit
+        for idx in section_indices:
+            self.section_required_masks[idx] |= bit
+        for sid in target_sections:
+            self.session_id_by_section.setdefault((course.course_id, kind.type, sid), session_id)
+        return session_id
+
     def _get_qualified_instructors(self, course_id: str, session_type: str) -> List[str]:
         """Get instructors qualified for this course"""
         qualified = []
@@ -193,8 +706,13 @@ class BacktrackingScheduler:
 
         return suitable
 
+    def _slot_mask(self, day: int, period: int, duration: int) -> int:
+        """Bitset of the week slots covered by a session (bit = day * PERIODS_PER_DAY + period)"""
+        return ((1 << duration) - 1) << (day * self.PERIODS_PER_DAY + period)
+
     def _is_valid_assignment(self, sections: List[str], day: int, period: int,
-                             duration: int, instructor_id: str, room_id: str) -> bool:
+                             duration: int, instructor_id: str, room_id: str,
+                             clusters: List[int] = ()) -> bool:
         """Check if assignment is valid"""
         # Check period alignment (90-min must start at even period)
         if duration == 2 and period % 2 != 0:
@@ -204,53 +722,211 @@ class BacktrackingScheduler:
         if period + duration > self.PERIODS_PER_DAY:
             return False
 
+        # Same as _slot_mask, inlined: this is the innermost call of every search
+        mask = ((1 << duration) - 1) << (day * self.PERIODS_PER_DAY + period)
+
         # Check section conflicts
         for section_id in sections:
-            for p in range(period, period + duration):
-                if (section_id, day, p) in self.timetable:
-                    return False
+            if self.section_busy[self.section_index[section_id]] & mask:
+                return False
 
-        # Check instructor conflicts
-        for p in range(period, period + duration):
-            if (instructor_id, day, p) in self.instructor_busy:
+        # Check student conflicts across sections (electives, retakes)
+        for cluster in clusters:
+            if self.cluster_busy[cluster] & mask:
                 return False
 
+        # Check instructor conflicts (graduation projects may have none)
+        if instructor_id != "N/A" and self.instructor_busy.get(instructor_id, 0) & mask:
+            return False
+
         # Check room conflicts (skip for graduation projects)
-        if room_id != "N/A":
-            for p in range(period, period + duration):
-                if (room_id, day, p) in self.room_busy:
-                    return False
+        if room_id != "N/A" and self.room_busy.get(room_id, 0) & mask:
+            return False
 
         return True
 
+    def _free_slot_mask(self, session_id: int, day: int, period: int) -> int:
+        """
+        The part of the check that does not depend on instructor or room:
+        alignment, bounds, sections and student clusters, read from the
+        session columns. Sections take one AND per covered slot against the
+        transposed slot -> sections bitsets. Returns the session's slot mask,
+        or 0 if it cannot start here.
+        """
+        duration = self.session_durations[session_id]
+        if duration == 2 and period & 1:
+            return 0
+        if period + duration > self.PERIODS_PER_DAY:
+            return 0
+
+        slot = day * self.PERIODS_PER_DAY + period
+        sections = self.session_section_masks[session_id]
+        slot_section_busy = self.slot_section_busy
+        busy = slot_section_busy[slot]
+        if duration == 2:
+            busy |= slot_section_busy[slot + 1]
+        elif duration > 2:
+            for s in range(slot + 1, slot + duration):
+                busy |= slot_section_busy[s]
+        if busy & sections:
+            return 0
+
+        mask = ((1 << duration) - 1) << slot
+        for cluster in self.session_clusters[session_id]:
+            if self.cluster_busy[cluster] & mask:
+                return 0
+        if self.section_limits is not None and not self._sections_within_limits(session_id, day, mask):
+            return 0
+        return mask
+
+    def _is_valid_session(self, session_id: int, day: int, period: int, instructor_id: str, room_id: str) -> bool:
+        """_is_valid_assignment for a compiled session"""
+        # Same as _free_slot_mask, inlined: this is the innermost call of iter_search
+        duration = self.session_durations[session_id]
+        if duration == 2 and period & 1:
+            return False
+        if period + duration > self.PERIODS_PER_DAY:
+            return False
+
+        slot = day * self.PERIODS_PER_DAY + period
+        sections = self.session_section_masks[session_id]
+        slot_section_busy = self.slot_section_busy
+        busy = slot_section_busy[slot]
+        if duration == 2:
+            busy |= slot_section_busy[slot + 1]
+        elif duration > 2:
+            for s in range(slot + 1, slot + duration):
+                busy |= slot_section_busy[s]
+        if busy & sections:
+            return False
+
+        mask = ((1 << duration) - 1) << slot
+        for cluster in self.session_clusters[session_id]:
+            if self.cluster_busy[cluster] & mask:
+                return False
+        if self.section_limits is not None and not self._sections_within_limits(session_id, day, mask):
+            return False
+        if instructor_id != "N/A" and self.instructor_busy.get(instructor_id, 0) & mask:
+            return False
+        if instructor_id != "N/A" and self.instructor_limits is not None and \
+                not self._instructor_within_limits(instructor_id, day, mask, session_id):
+            return False
+        if room_id != "N/A" and self.room_busy.get(room_id, 0) & mask:
+            return False
+        if self.travel_hard and self._travel_cost(self.compiled_sessions[session_id].section_indices,
+                                                  instructor_id, slot, duration, room_id):
+            return False
+        return True
+
+    def _skip_attempts(self, count: int):
+        """Count attempts ruled out together, keeping the checkpoint every 4096 attempts"""
+        before = self.attempts
+        self.attempts += count
+        if before >> 12 != self.attempts >> 12 and self.deadline is not None:
+            self._check_deadline()
+
     def _place_assignment(self, assignment: Assignment):
         """Place an assignment in the timetable"""
+        mask = self._slot_mask(assignment.day, assignment.period, assignment.duration)
+
+        section_mask = 0
         for section_id in assignment.sections:
+            idx = self.section_index[section_id]
+            self.section_busy[idx] |= mask
+            section_mask |= 1 << idx
+            if self.section_limits is not None:
+                self.section_day_periods[idx][assignment.day] += assignment.duration
             for p in range(assignment.period, assignment.period + assignment.duration):
                 self.timetable[(section_id, assignment.day, p)] = assignment
-            # Track specific session type for each section
-            for section_id in assignment.sections:
-                self.scheduled_sessions[section_id].add((assignment.course_id, assignment.session_type))
-
-        for p in range(assignment.period, assignment.period + assignment.duration):
-            self.instructor_busy.add((assignment.instructor_id, assignment.day, p))
-            if assignment.room_id != "N/A":
-                self.room_busy.add((assignment.room_id, assignment.day, p))
+        first_slot = assignment.day * self.PERIODS_PER_DAY + assignment.period
+        slot_section_busy = self.slot_section_busy
+        for slot in range(first_slot, first_slot + assignment.duration):
+            slot_section_busy[slot] |= section_mask
+
+        # Track the placed session for each attending section
+        if assignment.session_id >= 0:
+            bit = 1 << assignment.session_id
+            self.placed_sessions |= bit
+            self.session_slot[assignment.session_id] = first_slot
+            if assignment.session_id in self.precedence_links:
+                self._narrow_linked(assignment.session_id, first_slot)
+            for idx in self.compiled_sessions[assignment.session_id].section_indices:
+                self.scheduled_masks[idx] |= bit
+            for cluster in self.compiled_sessions[assignment.session_id].cluster_indices:
+                self.cluster_busy[cluster] |= mask
+
+            if self.solutions:
+                slot = assignment.day * self.PERIODS_PER_DAY + assignment.period
+                for j, slots in enumerate(self.solutions):
+                    if slots[assignment.session_id] == slot:
+                        self.solution_agree[j] += 1
+
+        if assignment.instructor_id != "N/A":
+            self.instructor_busy[assignment.instructor_id] = self.instructor_busy.get(assignment.instructor_id, 0) | mask
+            if self.instructor_limits is not None:
+                periods = self.instructor_day_periods.setdefault(assignment.instructor_id, [0] * self.DAYS)
+                periods[assignment.day] += assignment.duration
+                self.instructor_sessions[assignment.instructor_id] = \
+                    self.instructor_sessions.get(assignment.instructor_id, 0) + 1
+        if assignment.room_id is None:
+            self.room_pool.place(self.room_pool.session_masks[assignment.session_id], first_slot, assignment.duration)
+        elif assignment.room_id != "N/A":
+            self.room_busy[assignment.room_id] = self.room_busy.get(assignment.room_id, 0) | mask
+            if self.room_pool is not None:
+                self.room_pool.take(assignment.room_id, first_slot, assignment.duration)
+        if self.travel is not None:
+            self._track_buildings(assignment, first_slot, True)
 
     def _remove_assignment(self, assignment: Assignment):
         """Remove an assignment from the timetable"""
+        mask = self._slot_mask(assignment.day, assignment.period, assignment.duration)
+
+        section_mask = 0
         for section_id in assignment.sections:
+            idx = self.section_index[section_id]
+            self.section_busy[idx] &= ~mask
+            section_mask |= 1 << idx
+            if self.section_limits is not None:
+                self.section_day_periods[idx][assignment.day] -= assignment.duration
             for p in range(assignment.period, assignment.period + assignment.duration):
                 if (section_id, assignment.day, p) in self.timetable:
                     del self.timetable[(section_id, assignment.day, p)]
-            # Remove specific session type tracking
-            for section_id in assignment.sections:
-                self.scheduled_sessions[section_id].discard((assignment.course_id, assignment.session_type))
-
-        for p in range(assignment.period, assignment.period + assignment.duration):
-            self.instructor_busy.discard((assignment.instructor_id, assignment.day, p))
-            if assignment.room_id != "N/A":
-                self.room_busy.discard((assignment.room_id, assignment.day, p))
+        first_slot = assignment.day * self.PERIODS_PER_DAY + assignment.period
+        slot_section_busy = self.slot_section_busy
+        for slot in range(first_slot, first_slot + assignment.duration):
+            slot_section_busy[slot] &= ~section_mask
+
+        # Remove the placed session tracking
+        if assignment.session_id >= 0:
+            bit = 1 << assignment.session_id
+            self.placed_sessions &= ~bit
+            self.session_slot[assignment.session_id] = -1
+            if assignment.session_id in self.precedence_links:
+                self._widen_linked(assignment.session_id)
+            for idx in self.compiled_sessions[assignment.session_id].section_indices:
+                self.scheduled_masks[idx] &= ~bit
+            for cluster in self.compiled_sessions[assignment.session_id].cluster_indices:
+                self.cluster_busy[cluster] &= ~mask
+
+            if self.solutions:
+                slot = assignment.day * self.PERIODS_PER_DAY + assignment.period
+                for j, slots in enumerate(self.solutions):
+                    if slots[assignment.session_id] == slot:
+                        self.solution_agree[j] -= 1
+
+        if assignment.instructor_id != "N/A":
+            self.instructor_busy[assignment.instructor_id] &= ~mask
+            if self.instructor_limits is not None:
+                self.instructor_day_periods[assignment.instructor_id][assignment.day] -= assignment.duration
+                self.instructor_sessions[assignment.instructor_id] -= 1
+        if assignment.room_id is None:
+            self.room_pool.unplace(self.room_pool.session_masks[assignment.session_id], first_slot, assignment.duration)
+        elif assignment.room_id != "N/A":
+            self.room_busy[assignment.room_id] &= ~mask
+            if self.room_pool is not None:
+                self.room_pool.release(assignment.room_id, first_slot, assignment.duration)
+        if self.travel is not None:
+            self._track_buildings(assignment, first_slot, False)
 
     def _get_target_sections(self, course: Course, kind: CourseKind,
                              reference_section: Section) -> List[List[str]]:
@@ -295,175 +971,1159 @@ class BacktrackingScheduler:
                         if self.group_by_id[s.group_id].year == course.year and
                         (course.major is None or self.group_by_id[s.group_id].specialization == course.major)]
 
-            # Smart grouping
-            max_per_lab = kind.max_sections_together
-            groups = []
-            current_group = []
+            key = (course.course_id, id(kind))
+            if key not in self.lab_groups:
+                self.lab_groups[key] = self._group_lab_sections(
+                    sections, kind, self.hinted_lab_groups.get(course.course_id, ()))
+            return self.lab_groups[key]
 
-            for section in sections:
-                if len(current_group) < max_per_lab:
-                    current_group.append(section.section_id)
+        return []
+
+    def _group_lab_sections(self, sections: List[Section], kind: CourseKind,
+                            hinted: Iterable[List[str]] = ()) -> List[List[str]]:
+        """
+        Partition sections into lab sessions, using as few as possible.
+        A lab holds at most max_sections_together sections and, unless the
+        kind ignores capacity, no more students than the largest room of its
+        lab type. Sections are first packed within their own group, so labs
+        follow the group structure the lectures already use; the partly
+        filled labs left over are then merged across groups where they fit.
+        Hinted groups (a warm start's labs) that fit are kept as they are
+        and only the remaining sections are packed.
+        """
+        max_per_lab = max(kind.max_sections_together, 1)
+        if kind.ignore_capacity:
+            capacity = float('inf')
+        else:
+            capacity = max((r.capacity for r in self.rooms if r.type == kind.lab_type), default=float('inf'))
+
+        order = {s.section_id: i for i, s in enumerate(sections)}
+        kept = []
+        for section_ids in hinted:
+            if len(section_ids) <= max_per_lab and all(sid in order for sid in section_ids) and \
+                    sum(self.section_by_id[sid].students_count for sid in section_ids) <= capacity:
+                kept.append([0, list(section_ids)])
+                for sid in section_ids:
+                    del order[sid]
+        sections = [s for s in sections if s.section_id in order]
+
+        def first_fit_decreasing(items):
+            # items: (students, [section_id, ...]); returns packed bins of the same shape
+            bins = []
+            for students, section_ids in sorted(items, key=lambda item: -item[0]):
+                for b in bins:
+                    if len(b[1]) + len(section_ids) <= max_per_lab and b[0] + students <= capacity:
+                        b[0] += students
+                        b[1].extend(section_ids)
+                        break
                 else:
-                    groups.append(current_group)
-                    current_group = [section.section_id]
+                    bins.append([students, list(section_ids)])
+            return bins
+
+        full, partial = [], []
+        by_group = defaultdict(list)
+        for section in sections:
+            by_group[section.group_id].append((section.students_count, [section.section_id]))
+        for items in by_group.values():
+            for b in first_fit_decreasing(items):
+                is_full = len(b[1]) == max_per_lab or b[0] + min(i[0] for i in items) > capacity
+                (full if is_full else partial).append(b)
+
+        labs = kept + full + first_fit_decreasing(partial)
+
+        # Keep input order inside and across labs
+        order = {s.section_id: i for i, s in enumerate(self.sections)}
+        labs = [sorted(section_ids, key=order.get) for _, section_ids in labs]
+        labs.sort(key=lambda section_ids: order[section_ids[0]])
+        return labs
+
+    def _get_project_groups(self, course: Course) -> List[List[str]]:
+        """Section lists of every group that takes this graduation project"""
+        return [[s.section_id for s in self.sections_by_group[g.group_id]]
+                for g in self.groups
+                if g.year == course.year and (course.major is None or g.specialization == course.major)
+                and self.sections_by_group[g.group_id]]
 
-            if current_group:
-                groups.append(current_group)
+    def _is_course_complete_for_section(self, course: Course, section_id: str) -> bool:
+        """Check if all session types for a course are scheduled for a section"""
+        idx = self.section_index[section_id]
+        required = self.section_required_masks[idx] & self.course_masks[course.course_id]
+        return required & ~self.scheduled_masks[idx] == 0
 
-            return groups if groups else [[s.section_id] for s in sections]
+    def _is_section_complete(self, section_idx: int) -> bool:
+        """Check if every session the section attends is placed"""
+        return self.section_required_masks[section_idx] & ~self.scheduled_masks[section_idx] == 0
 
-        return []
+    def _get_section_progress(self) -> Dict[str, Tuple[int, int]]:
+        """Placed and required session counts per section"""
+        return {
+            section.section_id: (self.scheduled_masks[idx].bit_count(),
+                                 self.section_required_masks[idx].bit_count())
+            for idx, section in enumerate(self.sections)
+        }
 
-    def _is_course_complete_for_section(self, course: Course, section_id: str) -> bool:
-        """Check if all session types for a course are scheduled for a section"""
-        required_sessions = {(course.course_id, kind.type) for kind in course.kinds}
-        scheduled_for_section = self.scheduled_sessions[section_id]
-        return required_sessions.issubset(scheduled_for_section)
+    def _get_strategy_sessions(self, strategy: str) -> List[int]:
+        """Compiled session ids the strategy places, with student clusters attached"""
+        if strategy in ("section", "day"):
+            session_ids = [session_id for queue in self.section_queues for session_id in queue]
+        else:
+            session_ids = self._get_all_sessions_to_schedule()
+        # Section queues leave out graduation projects; the anchors bring them in
+        placed = set(session_ids)
+        session_ids += [s for s in self._get_anchor_sessions() if s not in placed]
 
-    # ==================== STRATEGY 1: SECTION-BY-SECTION ====================
+        self._compile_enrollments(session_ids)
+        self._compile_precedence(session_ids)
+        self._compile_workload(session_ids)
+        return session_ids
+
+    # ==================== INSTANCE FEATURES ====================
 
-    def solve_by_section(self, section_idx: int = 0) -> bool:
+    def _instance_features(self, session_ids: List[int]) -> Dict:
         """
-        Backtracking by section (like C++ implementation).
-        For each section, schedule all its courses before moving to next section.
+        Cheap size and tightness measures for strategy selection. Room and
+        instructor demand is spread evenly over each session's candidates.
         """
-        if section_idx >= len(self.sections):
-            return True  # All sections scheduled
+        week = self.DAYS * self.PERIODS_PER_DAY
+        sessions = [self.compiled_sessions[s] for s in session_ids]
+        room_load = defaultdict(float)
+        instructor_load = defaultdict(float)
+        section_sessions = defaultdict(int)  # section index -> bitset of positions in sessions
+        sole_instructor = defaultdict(int)  # instructor_id -> bitset of positions
+
+        for pos, session in enumerate(sessions):
+            for room_id in session.rooms:
+                room_load[room_id] += session.duration / len(session.rooms)
+            for instructor_id in session.instructors:
+                instructor_load[instructor_id] += session.duration / len(session.instructors)
+            for idx in session.section_indices:
+                section_sessions[idx] |= 1 << pos
+            if len(session.instructors) == 1:
+                sole_instructor[session.instructors[0]] |= 1 << pos
+
+        # Room tightness per type
+        demand_by_type = defaultdict(float)
+        rooms_by_type = defaultdict(int)
+        for room in self.rooms:
+            rooms_by_type[room.type] += 1
+            demand_by_type[room.type] += room_load.get(room.room_id, 0.0)
+        room_tightness = {t: demand_by_type[t] / (rooms_by_type[t] * week) for t in rooms_by_type}
+
+        instructor_factors = [load / week for instr_id, load in instructor_load.items() if instr_id != "N/A"]
+
+        # Conflict graph: sessions sharing a section or a sole qualified instructor
+        neighbours = [0] * len(sessions)
+        for mask in list(section_sessions.values()) + list(sole_instructor.values()):
+            m = mask
+            while m:
+                low = m & -m
+                neighbours[low.bit_length() - 1] |= mask
+                m ^= low
+        edges = sum(n.bit_count() - 1 for n in neighbours) / 2
+        pairs = len(sessions) * (len(sessions) - 1) / 2
+
+        sizes = [len(s.sections) for s in sessions] or [0]
+        durations = [s.duration for s in sessions] or [0]
+        return {
+            'sessions': len(sessions),
+            'log_sessions': math.log(max(len(sessions), 1)),
+            'mean_sections_per_session': sum(sizes) / len(sizes),
+            'max_sections_per_session': max(sizes),
+            'mean_duration': sum(durations) / len(durations),
+            'room_tightness': room_tightness,
+            'max_room_tightness': max(room_tightness.values(), default=0.0),
+            'mean_instructor_load': sum(instructor_factors) / len(instructor_factors) if instructor_factors else 0.0,
+            'max_instructor_load': max(instructor_factors, default=0.0),
+            'conflict_density': edges / pairs if pairs else 0.0
+        }
 
-        section = self.sections[section_idx]
+    # ==================== STUDENT ENROLLMENTS ====================
 
-        # Get courses this section needs
-        eligible_courses = [
-            c for c in self.courses
-            if c.year == self.group_by_id[section.group_id].year and
-               (c.major is None or c.major == self.group_by_id[section.group_id].specialization)
-        ]
+    def _compile_enrollments(self, session_ids: List[int]):
+        """
+        Turn data['students'] into student clusters. Each student lists
+        enrollments as {"course_id", "section_id"}: the student attends that
+        course's sessions with that section. Students who attend exactly the
+        same sessions share one cluster and one occupancy bitset. Clusters
+        whose sessions all share a section are already covered by the
+        section bitsets, and clusters contained in a larger one are implied
+        by it, so both are dropped.
+        """
+        wanted = set(session_ids)
+        students_by_sessions = defaultdict(int)  # frozenset of session ids -> student count
+
+        for student in self.data.get('students', []):
+            attended = set()
+            for enrollment in student['enrollments']:
+                course = self.course_by_id.get(enrollment['course_id'])
+                if course is None:
+                    raise ValueError(f"Student {student.get('student_id')} enrolled in unknown course "
+                                     f"{enrollment['course_id']}")
+                for kind in course.kinds:
+                    session_id = self.session_id_by_section.get(
+                        (course.course_id, kind.type, enrollment['section_id']))
+                    if session_id in wanted:
+                        attended.add(session_id)
+            students_by_sessions[frozenset(attended)] += 1
+
+        kept = []
+        for attended in sorted(students_by_sessions, key=len, reverse=True):
+            if len(attended) < 2:
+                continue
+            shared_sections = set.intersection(
+                *(set(self.compiled_sessions[s].section_indices) for s in attended))
+            if shared_sections:
+                continue
+            if any(attended <= other for other in kept):
+                continue
+            kept.append(attended)
 
-        # Check if all courses for this section are completely scheduled
-        all_scheduled = all(
-            self._is_course_complete_for_section(course, section.section_id)
-            for course in eligible_courses
-        )
+        for cluster, attended in enumerate(kept):
+            self.cluster_busy.append(0)
+            self.cluster_sizes.append(sum(count for sessions, count in students_by_sessions.items()
+                                          if sessions <= attended))
+            for session_id in attended:
+                self.compiled_sessions[session_id].cluster_indices.append(cluster)
 
-        if all_scheduled:
-            return self.solve_by_section(section_idx + 1)
+        if self.data.get('students'):
+            print(f"Student clusters: {len(kept)} (from {len(self.data['students'])} students)")
 
-        # Find an unscheduled course session
-        for course in eligible_courses:
-            # Skip if course is already complete for this section
-            if self._is_course_complete_for_section(course, section.section_id):
-                continue
+    # ==================== PRECEDENCE ====================
+
+    def _compile_precedence(self, session_ids: List[int]):
+        """
+        Link every session to the sessions it must follow or precede
+        (precedence_rules: e.g. a section's lab after its lecture). Placing
+        a session narrows its partners' start slots in precedence_blocked,
+        which the search folds into the learned-nogood bitset it already
+        tests, so precedence adds nothing to the inner loops.
+        """
+        self.precedence_links = {}
+        self.precedence_blocked = {}
+        rules = precedence_rules(self.data)
+        if not rules:
+            return
+
+        by_section = {}  # (course_id, session_type, section_id) -> session id
+        for session_id in session_ids:
+            session = self.compiled_sessions[session_id]
+            for section_id in session.sections:
+                by_section.setdefault((session.course.course_id, session.kind.type, section_id), session_id)
+
+        links = defaultdict(dict)
+        for session_id in session_ids:
+            session = self.compiled_sessions[session_id]
+            for before, after, gap, same_day in rules.get(session.course.course_id, ()):
+                if session.kind.type != after:
+                    continue
+                for section_id in session.sections:
+                    pred = by_section.get((session.course.course_id, before, section_id))
+                    if pred is None or pred == session_id:
+                        continue
+                    links[pred][session_id] = (session_id, True, gap, same_day)
+                    links[session_id][pred] = (pred, False, gap, same_day)
+
+        self.precedence_links = {session_id: list(partners.values()) for session_id, partners in links.items()}
+        for session_id in self.precedence_links:
+            if self.session_slot[session_id] >= 0:
+                self._narrow_linked(session_id, self.session_slot[session_id])
+
+    def _precedence_block(self, session_id: int, slot: int, other: int, other_follows: bool,
+                          gap: int, same_day: bool) -> int:
+        """
+        Start slots of `other` ruled out by session_id starting at slot.
+        Slots are numbered in week order, so each rule is a low or high
+        mask cut at one slot (plus the other days for same-day pairs).
+        """
+        P = self.PERIODS_PER_DAY
+        week = (1 << self.TOTAL_SLOTS) - 1
+        day = slot // P
+        if other_follows:
+            # Starts once this session is over (gap days later)
+            earliest = (day + gap) * P if gap and not same_day else slot + self.session_durations[session_id]
+            blocked = (1 << min(earliest, self.TOTAL_SLOTS)) - 1
+            if same_day:
+                blocked |= week >> ((day + 1) * P) << ((day + 1) * P)
+        else:
+            # Ends by the time this session starts (gap days earlier)
+            latest = slot - self.session_durations[other]
+            if gap and not same_day:
+                latest = min(latest, (day - gap + 1) * P - 1)
+            blocked = week & ~((1 << (latest + 1)) - 1) if latest >= 0 else week
+            if same_day:
+                blocked |= (1 << (day * P)) - 1
+        return blocked
+
+    def _narrow_linked(self, session_id: int, slot: int):
+        blocked = self.precedence_blocked
+        for other, other_follows, gap, same_day in self.precedence_links[session_id]:
+            blocked[other] = blocked.get(other, 0) | self._precedence_block(
+                session_id, slot, other, other_follows, gap, same_day)
+
+    def _widen_linked(self, session_id: int):
+        """Recompute the partners' blocked starts from their other placed partners"""
+        for other, _, _, _ in self.precedence_links[session_id]:
+            mask = 0
+            for partner, partner_follows, gap, same_day in self.precedence_links[other]:
+                slot = self.session_slot[partner]
+                if slot >= 0:
+                    # The partner's link from `other`; seen from the partner the direction flips
+                    mask |= self._precedence_block(partner, slot, other, not partner_follows, gap, same_day)
+            if mask:
+                self.precedence_blocked[other] = mask
+            else:
+                self.precedence_blocked.pop(other, None)
 
-            if course.is_project:
+    def _precedence_allows_day(self, session_id: int, day: int, day_of: Dict[int, int]) -> bool:
+        """Day-level precedence for _assign_days: partners already given a day keep their order"""
+        for other, other_follows, gap, same_day in self.precedence_links.get(session_id, ()):
+            other_day = day_of.get(other)
+            if other_day is None:
                 continue
+            if same_day:
+                if other_day != day:
+                    return False
+            elif other_follows and other_day < day + gap:
+                return False
+            elif not other_follows and day < other_day + gap:
+                return False
+        return True
 
-            # Try to schedule each session type that's not yet scheduled
-            for kind in course.kinds:
-                # Check if this session type is already scheduled for this section
-                if (course.course_id, kind.type) in self.scheduled_sessions[section.section_id]:
-                    continue
+    # ==================== WORKLOAD LIMITS ====================
 
-                target_groups = self._get_target_sections(course, kind, section)
+    def _compile_workload(self, session_ids: List[int]):
+        """
+        Sessions per section and the days each must reach (min days never
+        exceeds its sessions); sessions each instructor may teach
+        """
+        self.section_session_masks = [0] * len(self.sections)
+        self.instructor_session_masks = defaultdict(int)
+        for session_id in session_ids:
+            for idx in self.compiled_sessions[session_id].section_indices:
+                self.section_session_masks[idx] |= 1 << session_id
+            for instructor_id in self.compiled_sessions[session_id].instructors:
+                if instructor_id != "N/A":
+                    self.instructor_session_masks[instructor_id] |= 1 << session_id
+        min_days = self.section_limits[2] if self.section_limits is not None else 0
+        self.section_min_days = [min(min_days, mask.bit_count()) for mask in self.section_session_masks]
+
+    def _sections_within_limits(self, session_id: int, day: int, mask: int) -> bool:
+        """
+        Daily limits of every attending section with the session added:
+        periods that day from the per-day counters, the longest busy run
+        from a lookup on the day's byte, and on a day already in use,
+        whether the sessions left can still reach the minimum days
+        """
+        max_periods, max_consecutive, _ = self.section_limits
+        duration = self.session_durations[session_id]
+        shift = day * self.PERIODS_PER_DAY
+        for idx in self.compiled_sessions[session_id].section_indices:
+            periods = self.section_day_periods[idx]
+            if periods[day] + duration > max_periods:
+                return False
+            if LONGEST_RUN[(self.section_busy[idx] | mask) >> shift & 0xFF] > max_consecutive:
+                return False
+            if periods[day] and self.section_min_days[idx]:
+                days_used = sum(1 for p in periods if p)
+                left = (self.section_session_masks[idx] & ~self.placed_sessions & ~(1 << session_id)).bit_count()
+                if days_used + left < self.section_min_days[idx]:
+                    return False
+        return True
+
+    def _instructor_within_limits(self, instructor_id: str, day: int, mask: int, session_id: int) -> bool:
+        """
+        Periods that day and the longest busy run for the instructor with
+        mask added, and on a day already in use, whether the sessions they
+        may still teach can reach the minimum days. The minimum is capped
+        by the sessions taught, so the best case is every session left
+        (at most one per free day) going on a new day.
+        """
+        max_periods, max_consecutive, min_days = self.instructor_limits
+        periods = self.instructor_day_periods.get(instructor_id)
+        if (periods[day] if periods else 0) + mask.bit_count() > max_periods:
+            return False
+        busy = self.instructor_busy.get(instructor_id, 0) | mask
+        if LONGEST_RUN[busy >> (day * self.PERIODS_PER_DAY) & 0xFF] > max_consecutive:
+            return False
+        if min_days and periods and periods[day]:
+            days_used = sum(1 for p in periods if p)
+            left = (self.instructor_session_masks.get(instructor_id, 0) & ~self.placed_sessions
+                    & ~(1 << session_id)).bit_count()
+            reachable = min(left, self.DAYS - days_used)
+            if min(min_days, self.instructor_sessions[instructor_id] + 1 + reachable) > days_used + reachable:
+                return False
+        return True
+
+    def _instructor_days_short(self) -> int:
+        """Days instructors are short of their minimum per week (checked on complete timetables)"""
+        min_days = self.instructor_limits[2]
+        if not min_days:
+            return 0
+        sessions = defaultdict(int)
+        for assignment in {id(a): a for a in self.timetable.values()}.values():
+            if assignment.instructor_id != "N/A":
+                sessions[assignment.instructor_id] += 1
+        return sum(max(min(min_days, count) - sum(1 for p in self.instructor_day_periods[instructor_id] if p), 0)
+                   for instructor_id, count in sessions.items())
+
+    # ==================== BUILDING TRAVEL ====================
+
+    def _compile_travel(self):
+        """
+        Building indices and the flat table of cost classes between them:
+        1 for pairs too far apart for back-to-back sessions in hard mode
+        (0 otherwise), the distance itself in soft mode
+        """
+        _, max_distance, distance = self.travel
+        buildings = sorted({room.building for room in self.rooms})
+        index = {building: i for i, building in enumerate(buildings)}
+        self.building_count = len(buildings)
+        self.room_building = {room.room_id: index[room.building] for room in self.rooms}
+        costs = [distance(a, b) for a in buildings for b in buildings]
+        self.travel_costs = [int(d > max_distance) for d in costs] if self.travel_hard else costs
+        self.section_slot_building = [[-1] * self.TOTAL_SLOTS for _ in self.sections]
+
+    def _travel_cost(self, section_indices: List[int], instructor_id: str, first_slot: int,
+                     duration: int, room_id: str) -> int:
+        """
+        Cost classes of the moves to and from the periods just before and
+        after the session (same day only) for every attending section and
+        the instructor. Two table lookups per entity; 0 for roomless sessions.
+        """
+        building = self.room_building.get(room_id, -1)
+        if building < 0:
+            return 0
+        costs = self.travel_costs
+        row = building * self.building_count
+        before = first_slot - 1 if first_slot % self.PERIODS_PER_DAY else -1
+        after = first_slot + duration if (first_slot + duration) % self.PERIODS_PER_DAY else -1
+
+        cost = 0
+        rows = [self.section_slot_building[idx] for idx in section_indices]
+        if instructor_id in self.instructor_slot_building:
+            rows.append(self.instructor_slot_building[instructor_id])
+        for slots in rows:
+            if before >= 0 and slots[before] >= 0:
+                cost += costs[row + slots[before]]
+            if after >= 0 and slots[after] >= 0:
+                cost += costs[row + slots[after]]
+        return cost
+
+    def _track_buildings(self, assignment: Assignment, first_slot: int, placing: bool):
+        """Write (or clear) the session's building in its slots, keeping travel_penalty current"""
+        section_indices = [self.section_index[section_id] for section_id in assignment.sections]
+        if not placing:
+            building = -1
+        else:
+            self.travel_penalty += self._travel_cost(section_indices, assignment.instructor_id, first_slot,
+                                                     assignment.duration, assignment.room_id)
+            building = self.room_building.get(assignment.room_id, -1)
+
+        rows = [self.section_slot_building[idx] for idx in section_indices]
+        if assignment.instructor_id != "N/A":
+            rows.append(self.instructor_slot_building.setdefault(assignment.instructor_id, [-1] * self.TOTAL_SLOTS))
+        for slots in rows:
+            slots[first_slot:first_slot + assignment.duration] = [building] * assignment.duration
 
-                # Check if this session type is relevant to current section
-                section_involved = any(section.section_id in group for group in target_groups)
-                if not section_involved:
+        if not placing:
+            self.travel_penalty -= self._travel_cost(section_indices, assignment.instructor_id, first_slot,
+                                                     assignment.duration, assignment.room_id)
+
+    # ==================== PINNED / PREFERRED ASSIGNMENTS ====================
+
+    @staticmethod
+    def _hint_rows(entries: Iterable[Dict]) -> Dict[Tuple, List[str]]:
+        """
+        (course_id, type, day, start_period, room_id) -> section ids of the
+        hint rows that share it: the sections the hinted timetable put in
+        one session
+        """
+        groups = defaultdict(list)
+        for entry in entries:
+            key = (entry.get('course_id'), entry.get('session_type', entry.get('type')), entry.get('day'),
+                   entry.get('start_period'), entry.get('room_id'))
+            section_ids = [entry['section_id']] if entry.get('section_id') is not None else entry.get('sections') or []
+            groups[key].extend(sid for sid in section_ids if sid not in groups[key])
+        return groups
+
+    def _lab_groups_from_hints(self) -> Dict[str, List[List[str]]]:
+        """
+        course_id -> lab section groups of the pinned and preferred rows
+        (pinned first; a section keeps the first group it is seen in), so a
+        warm start keeps the lab partition of the timetable it came from
+        """
+        by_course = defaultdict(list)
+        grouped = set()  # (course_id, section_id)
+        for entries in (self.data.get('pinned_assignments') or [], self.data.get('preferred_assignments') or []):
+            for (course_id, session_type, *_), section_ids in self._hint_rows(entries).items():
+                section_ids = [sid for sid in section_ids
+                               if sid in self.section_by_id and (course_id, sid) not in grouped]
+                if session_type != "Lab" or not section_ids:
                     continue
+                grouped.update((course_id, sid) for sid in section_ids)
+                by_course[course_id].append(section_ids)
+        return dict(by_course)
 
-                # Find the group containing current section
-                target_sections = None
-                for group in target_groups:
-                    if section.section_id in group:
-                        target_sections = group
+    def _resolve_assignment_hint(self, entry: Dict) -> Optional[Tuple[int, Optional[int], Optional[int],
+                                                                      Optional[str], Optional[str]]]:
+        """
+        Map a schedule entry (the _extract_solution format) to
+        (session_id, day, period, instructor_id, room_id), 0-based.
+        Missing fields come back as None; unknown sessions as None.
+        Raises ValueError for a day name or index outside the week.
+        """
+        session_type = entry.get('session_type', entry.get('type'))
+        section_id = entry.get('section_id')
+        if section_id is None and entry.get('sections'):
+            section_id = entry['sections'][0]
+
+        session_id = self.session_id_by_section.get((entry.get('course_id'), session_type, section_id))
+        if session_id is None:
+            return None
+
+        day = entry.get('day')
+        if day is not None:
+            if isinstance(day, str) and day in self.DAY_NAMES:
+                day = self.DAY_NAMES.index(day)
+            elif isinstance(day, str) or isinstance(day, bool) or day not in range(self.DAYS):
+                raise ValueError(f"{entry.get('course_id')} ({session_type}) for {section_id} "
+                                 f"has unknown day {day!r}")
+
+        period = entry.get('start_period')
+        if period is not None:
+            period -= 1  # Entries are 1-based
+
+        return session_id, day, period, entry.get('instructor_id'), entry.get('room_id')
+
+    def _apply_assignment_hints(self, session_ids: List[int]) -> List[str]:
+        """
+        Apply data['preferred_assignments'] and data['pinned_assignments'] before search.
+
+        Preferred entries move their day, period, instructor and room to the
+        front of the session's value order, so the search tries the previous
+        placement first (warm start from an earlier result['schedule']).
+        Pinned entries restrict the session to the given values; a pin with
+        both day and start_period is placed right away and never backtracked.
+        Hints whose rows put a different set of sections in one session than
+        the compiled session has are not applied: preferred ones are listed
+        in hint_warnings, pinned ones are returned as conflicts.
+        Returns a message for every pin that cannot be honoured.
+        """
+        wanted = set(session_ids)
+        conflicts = []
+        preferred = self.data.get('preferred_assignments') or []
+        pinned = self.data.get('pinned_assignments') or []
+        reported = set()
+
+        def mismatch(entry: Dict, session_id: int, rows: Dict) -> Optional[str]:
+            key = (entry.get('course_id'), entry.get('session_type', entry.get('type')), entry.get('day'),
+                   entry.get('start_period'), entry.get('room_id'))
+            session = self.compiled_sessions[session_id]
+            if set(rows[key]) == set(session.sections) or key in reported:
+                return None
+            reported.add(key)
+            return (f"{session.course.course_id} ({session.kind.type}) for {', '.join(rows[key])} "
+                    f"does not match the session's sections {', '.join(session.sections)}")
+
+        preferred_rows = self._hint_rows(preferred)
+        for entry in preferred:
+            try:
+                hint = self._resolve_assignment_hint(entry)
+            except ValueError as e:
+                self.hint_warnings.append(f"Preferred {e}")
+                continue
+            if hint is None or hint[0] not in wanted or hint[0] in self.preferred_slots:
+                continue
+
+            session_id, day, period, instructor_id, room_id = hint
+            problem = mismatch(entry, session_id, preferred_rows)
+            if problem:
+                self.hint_warnings.append(f"Preferred {problem}")
+                continue
+            session = self.compiled_sessions[session_id]
+            self._move_to_front(session.days, day)
+            self._move_to_front(session.periods, period)
+            self._move_to_front(session.instructors, instructor_id)
+            self._move_to_front(session.rooms, room_id)
+            if day is not None and period is not None:
+                self.preferred_slots[session_id] = (day, period)
+
+        pinned_rows = self._hint_rows(pinned)
+        for entry in pinned:
+            try:
+                hint = self._resolve_assignment_hint(entry)
+            except ValueError as e:
+                conflicts.append(f"Pinned {e}")
+                continue
+            if hint is None:
+                conflicts.append(f"Unknown pinned session {entry.get('course_id')} "
+                                 f"({entry.get('session_type', entry.get('type'))}, {entry.get('section_id')})")
+                continue
+
+            session_id, day, period, instructor_id, room_id = hint
+            if session_id not in wanted or self.placed_sessions >> session_id & 1:
+                continue  # Not scheduled by this strategy, or already pinned via another section
+            problem = mismatch(entry, session_id, pinned_rows)
+            if problem:
+                conflicts.append(f"Pinned {problem}")
+                continue
+
+            session = self.compiled_sessions[session_id]
+            if day is not None:
+                session.days = [day]
+            if period is not None:
+                session.periods = [period]
+            if instructor_id is not None:
+                session.instructors = self.session_instructors[session_id] = [instructor_id]
+            if room_id is not None:
+                session.rooms = self.session_rooms[session_id] = [room_id]
+
+            if day is None or period is None:
+                continue
+
+            placed = False
+            for instructor in session.instructors:
+                for room in session.rooms:
+                    if self._is_valid_assignment(session.sections, day, period, session.duration,
+                                                 instructor, room, session.cluster_indices):
+                        self._place_assignment(Assignment(
+                            course_id=session.course.course_id,
+                            session_type=session.kind.type,
+                            sections=session.sections,
+                            instructor_id=instructor,
+                            room_id=room,
+                            day=day,
+                            period=period,
+                            duration=session.duration,
+                            session_id=session_id
+                        ))
+                        placed = True
                         break
+                if placed:
+                    break
 
-                if not target_sections:
+            if placed:
+                self.pinned_count += 1
+            else:
+                conflicts.append(f"Pinned {session.course.course_id} ({session.kind.type}) for "
+                                 f"{', '.join(session.sections)} conflicts at "
+                                 f"{self.DAY_NAMES[day]} period {period + 1}")
+
+        # Sessions the pins leave no slot for (e.g. a project's full day)
+        if self.pinned_count and not conflicts:
+            for session_id in session_ids:
+                session = self.compiled_sessions[session_id]
+                if self.placed_sessions >> session_id & 1 or \
+                        any(self._free_slot_mask(session_id, day, period)
+                            for day in session.days for period in session.periods):
                     continue
+                conflicts.append(f"{session.course.course_id} ({session.kind.type}) for "
+                                 f"{', '.join(session.sections)} has no free slot left around the pinned sessions")
 
-                # Check if already scheduled by another section in the group
-                already_scheduled = all(
-                    (course.course_id, kind.type) in self.scheduled_sessions[sid]
-                    for sid in target_sections
-                )
-                if already_scheduled:
-                    # Mark as scheduled for current section and continue
-                    self.scheduled_sessions[section.section_id].add((course.course_id, kind.type))
-                    return self.solve_by_section(section_idx)
+        return conflicts
 
-                # Try to schedule this session
-                students_count = sum(self.section_by_id[sid].students_count for sid in target_sections)
+    @staticmethod
+    def _move_to_front(values: List, value):
+        """Reorder values in place so that value is tried first"""
+        if value is not None and value in values:
+            values.remove(value)
+            values.insert(0, value)
 
-                qualified_instructors = self._get_qualified_instructors(course.course_id, kind.type)
-                if not qualified_instructors:
-                    print(f"No qualified instructor for {course.course_id} ({kind.type})")
-                    return False
+    # ==================== ANCHOR PRE-PLACEMENT ====================
 
+    def _get_anchor_sessions(self) -> List[int]:
+        """
+        Sessions that pin down a whole year or day: full-year lectures and
+        labs (all sections of a year at once) and graduation projects (a
+        full day per group). Largest first.
+        """
+        anchors = []
+        for course in self.courses:
+            for kind in course.kinds:
                 if course.is_project:
-                    suitable_rooms = ["N/A"]
+                    target_groups = self._get_project_groups(course)
+                elif course.full_year and kind.type in ("Lecture", "Lab") and self.sections_by_year[course.year]:
+                    target_groups = self._get_target_sections(course, kind, self.sections_by_year[course.year][0])
                 else:
-                    suitable_rooms = self._get_suitable_rooms(
-                        kind.type, students_count, kind.lab_type, kind.ignore_capacity
-                    )
-                    if not suitable_rooms:
-                        print(f"No suitable room for {course.course_id} ({kind.type}, {students_count} students)")
-                        return False
-
-                duration = kind.length // 45
-
-                # Try all combinations
-                for day in range(self.DAYS):
-                    for period in range(self.PERIODS_PER_DAY):
-                        for instructor_id in qualified_instructors:
-                            for room_id in suitable_rooms:
-                                self.attempts += 1
-
-                                if not self._is_valid_assignment(
-                                        target_sections, day, period, duration, instructor_id, room_id
-                                ):
-                                    continue
-
-                                # Place assignment
-                                assignment = Assignment(
-                                    course_id=course.course_id,
-                                    session_type=kind.type,
-                                    sections=target_sections,
-                                    instructor_id=instructor_id,
-                                    room_id=room_id,
-                                    day=day,
-                                    period=period,
-                                    duration=duration
-                                )
-                                self._place_assignment(assignment)
-
-                                # Recurse
-                                if self.solve_by_section(section_idx):
-                                    return True
-
-                                # Backtrack
-                                self.backtracks += 1
-                                self._remove_assignment(assignment)
-
-                # Failed to schedule this session type
+                    continue
+                for target_sections in target_groups:
+                    session_id = self._get_session_id(course, kind, target_sections)
+                    if session_id not in anchors:
+                        anchors.append(session_id)
+
+        anchors.sort(key=lambda s: -self.compiled_sessions[s].duration * len(self.compiled_sessions[s].sections))
+        return anchors
+
+    def _iter_anchor_placements(self, anchors: List[int], idx: int = 0):
+        """
+        Exact search over the anchors. Yields with every anchor placed,
+        leaving the state in place for the main search; resuming undoes
+        the placement and moves on to the next one.
+        """
+        if idx >= len(anchors):
+            yield
+            return
+
+        session = self.compiled_sessions[anchors[idx]]
+        if self.placed_sessions >> session.session_id & 1:
+            # Pinned before search
+            yield from self._iter_anchor_placements(anchors, idx + 1)
+            return
+
+        if idx == 0:
+            self.preferred_claims = self._preferred_claims(anchors)
+        blocked = self.precedence_blocked.get(session.session_id, 0)
+        candidates = [(day, period, instructor_id, room_id)
+                      for day in session.days
+                      for period in session.periods
+                      if not blocked >> (day * self.PERIODS_PER_DAY + period) & 1
+                      for instructor_id in session.instructors
+                      for room_id in session.rooms]
+        if self.preferred_claims:
+            # Stable: the anchor's own preferred slot and the hint order still lead among equals
+            candidates.sort(key=lambda c: self._displaced_preferences(session, *c))
+
+        for day, period, instructor_id, room_id in candidates:
+            self.attempts += 1
+            if not self._is_valid_session(session.session_id, day, period, instructor_id, room_id):
+                continue
+            if self.solutions and not self._keeps_diversity(session.session_id, day, period):
+                continue  # Enumerating: anchors count toward the distance like any session
+
+            assignment = Assignment(
+                course_id=session.course.course_id,
+                session_type=session.kind.type,
+                sections=session.sections,
+                instructor_id=instructor_id,
+                room_id=room_id,
+                day=day,
+                period=period,
+                duration=session.duration,
+                session_id=session.session_id
+            )
+            self._place_assignment(assignment)
+            yield from self._iter_anchor_placements(anchors, idx + 1)
+            self._remove_assignment(assignment)
+
+    def _preferred_claims(self, anchors: List[int]) -> Dict[Tuple[str, object], List[Tuple[int, int]]]:
+        """
+        Slots the preferred assignments of non-anchor sessions hold, per
+        ('section', index), ('instructor', id) and ('room', id): [(mask, session_id)].
+        _apply_assignment_hints moved the preferred instructor and room to the front.
+        """
+        claims = defaultdict(list)
+        anchor_ids = set(anchors)
+        for session_id, (day, period) in self.preferred_slots.items():
+            if session_id in anchor_ids or self.placed_sessions >> session_id & 1:
+                continue
+            session = self.compiled_sessions[session_id]
+            mask = self._slot_mask(day, period, session.duration)
+            for idx in session.section_indices:
+                claims[('section', idx)].append((mask, session_id))
+            claims[('instructor', session.instructors[0])].append((mask, session_id))
+            claims[('room', session.rooms[0])].append((mask, session_id))
+        return claims
+
+    def _displaced_preferences(self, session: CompiledSession, day: int, period: int,
+                               instructor_id: str, room_id: str) -> Tuple[int, int]:
+        """
+        Cost of placing an anchor here for the preferred assignments it
+        pushes out of their slot: (displaced ones left without a free slot
+        for their sections and any qualified instructor, displaced ones)
+        """
+        mask = self._slot_mask(day, period, session.duration)
+        keys = [('section', idx) for idx in session.section_indices]
+        if instructor_id != "N/A":
+            keys.append(('instructor', instructor_id))
+        if room_id != "N/A":
+            keys.append(('room', room_id))
+        displaced = {session_id for key in keys
+                     for other_mask, session_id in self.preferred_claims.get(key, ()) if other_mask & mask}
+
+        def held(key, entity_busy: int, skip: int) -> int:
+            for other_mask, session_id in self.preferred_claims.get(key, ()):
+                if session_id != skip:
+                    entity_busy |= other_mask
+            return entity_busy
+
+        stranded = 0
+        for session_id in displaced:
+            other = self.compiled_sessions[session_id]
+            busy = mask if set(other.section_indices) & set(session.section_indices) else 0
+            for idx in other.section_indices:
+                busy = held(('section', idx), busy | self.section_busy[idx], session_id)
+            free = 0
+            for other_instructor in other.instructors:
+                taken = mask if other_instructor == instructor_id else 0
+                free |= ~held(('instructor', other_instructor),
+                              taken | self.instructor_busy.get(other_instructor, 0), session_id)
+            free &= ~busy
+            step = 2 if other.duration == 2 else 1
+            if not any(self._slot_mask(d, p, other.duration) & ~free == 0
+                       for d in range(self.DAYS) for p in range(0, self.PERIODS_PER_DAY - other.duration + 1, step)):
+                stranded += 1
+        return stranded, len(displaced)
+
+    def _solve_with_anchors(self, search, anchors: List[int], max_time_seconds: int,
+                            max_rounds: int = 8) -> bool:
+        """
+        Place the anchors first, then run the main search on the slots they
+        leave free (their section/instructor/room bitsets act as blocked
+        masks). If the main search fails or runs out of its share of the
+        time, everything it placed is undone and the next anchor placement
+        is tried. The first round gets half the time budget (all of it
+        when there are no anchors to retry).
+        """
+        deadline = time.time() + max_time_seconds
+        before = set(id(a) for a in self.timetable.values())
+        self.search_exhausted = True
+
+        for round_idx, _ in enumerate(self._iter_anchor_placements(anchors)):
+            if round_idx >= max_rounds or time.time() >= deadline:
+                self.search_exhausted = False
                 return False
 
-        # All course sessions scheduled, move to next section
-        return self.solve_by_section(section_idx + 1)
+            blocked = {s.section_id: self.section_busy[i].bit_count()
+                       for i, s in enumerate(self.sections) if self.section_busy[i]}
+            self.anchor_stats.append({'round': round_idx + 1, 'blocked_section_periods': sum(blocked.values())})
+            print(f"Anchor round {round_idx + 1}: {len(anchors)} anchors block "
+                  f"{sum(blocked.values())} section-periods")
+
+            remaining = deadline - time.time()
+            if not anchors:
+                share = remaining  # Single round
+            else:
+                share = remaining / 2 if round_idx == 0 else remaining / (max_rounds - round_idx)
+            self.deadline = time.time() + share
+            try:
+                with span("search_round", round=round_idx + 1):
+                    found = search()
+                if found:
+                    self.deadline = None
+                    return True
+            except SearchTimeout:
+                self.search_exhausted = False
+                # Unwind whatever the interrupted search had placed
+                anchor_ids = set(anchors)
+                for assignment in list({id(a): a for a in self.timetable.values()}.values()):
+                    if id(assignment) not in before and assignment.session_id not in anchor_ids:
+                        self._remove_assignment(assignment)
+            self.deadline = None
+
+        return False
+
+    # ==================== SOLUTION ENUMERATION ====================
+
+    def _on_complete(self) -> bool:
+        """
+        Called when every session is placed. Returns True to stop the search;
+        while enumerating, records the solution and returns False so the
+        search backtracks into the next one.
+        """
+        if self.instructor_limits is not None and self._instructor_days_short():
+            return False  # Some instructor's sessions sit on too few days
+        if self.room_pool is not None and not self._bind_rooms():
+            return False  # No room binding for this timetable: keep searching
+        if not self.enumerating:
+            return True
+
+        slots = [-1] * len(self.compiled_sessions)
+        for assignment in self.timetable.values():
+            slots[assignment.session_id] = assignment.day * self.PERIODS_PER_DAY + assignment.period
+
+        if not self.solutions:
+            placed = self.placed_sessions.bit_count()
+            self.max_agree = placed - self.min_distance
+
+        self.solutions.append(slots)
+        self.solution_agree.append(self.placed_sessions.bit_count())
+        self.own_solutions.append(slots)
+        self.solution_results.append(self._extract_solution(time.time() - self.start_time))
+        if self.exchange is not None:
+            self.exchange.publish_solution(self.worker, slots)
+        print(f"Solution {len(self.solutions)} after {self.attempts:,} attempts")
+
+        return len(self.solutions) >= self.solution_target
+
+    def _keeps_diversity(self, session_id: int, day: int, period: int) -> bool:
+        """
+        Diversity nogood: placing the session must not make the partial
+        timetable agree with a recorded solution on more than max_agree
+        sessions, or it could never end min_distance slots away from it.
+        """
+        slot = day * self.PERIODS_PER_DAY + period
+        for j, slots in enumerate(self.solutions):
+            if self.solution_agree[j] + (slots[session_id] == slot) > self.max_agree:
+                return False
+        return True
+
+    def _check_deadline(self):
+        if self.exchange is not None:
+            self._import_shared()
+        self._check_preemption()
+        self._check_memory()
+        if time.time() > self.deadline:
+            raise SearchTimeout()
+
+    def _check_memory(self):
+        """
+        Sample memory (every checkpoint, budget or not, for the peak); over
+        budget, drop learned nogoods first and on the next checkpoint stop
+        the search, keeping what is placed as the partial timetable
+        """
+        memory = self.memory
+        if not memory.over_budget():
+            return
+        if self.keep_nogoods:
+            self.keep_nogoods = False
+            self.forbidden_starts = {}
+            memory.degrade("dropped learned nogoods")
+            return
+        if self.partial_columns is None:
+            if self.room_pool is not None:
+                # Sessions without a room left are reported unplaced
+                self._bind_rooms(best_effort=True)
+                for assignment in {id(a): a for a in self.timetable.values()}.values():
+                    if assignment.room_id is None:
+                        self._remove_assignment(assignment)
+            self.partial_columns = self._extract_columns()
+            self.partial_unplaced = len(self.compiled_sessions) - self.placed_sessions.bit_count()
+        memory.degrade("search stopped, returning the partial timetable")
+        raise SearchMemoryExceeded()
+
+    def _check_preemption(self):
+        if self.preemption_slot is not None and _preemption_flags[self.preemption_slot]:
+            raise SearchPreempted()
+
+    def _import_shared(self):
+        """
+        Pull what other workers published. Their solutions become diversity
+        nogoods here too, so no two workers settle near the same timetable;
+        learned nogoods become forbidden start slots.
+        """
+        new_solutions = self.exchange.read_solutions(self.worker, self.exchange_seen)
+        if new_solutions:
+            placed = {a.session_id: a for a in self.timetable.values()}
+            for slots in new_solutions:
+                if not self.solutions:
+                    self.max_agree = sum(1 for slot in slots if slot >= 0) - self.min_distance
+                self.solutions.append(slots)
+                self.solution_agree.append(sum(
+                    1 for session_id, a in placed.items()
+                    if slots[session_id] == a.day * self.PERIODS_PER_DAY + a.period))
+
+        if self.keep_nogoods:
+            self.forbidden_starts = self.exchange.read_nogoods()
+
+        if len(self.solutions) >= self.solution_target:
+            raise SearchStopped()
+
+    def _learn_root_nogood(self, session_id: int, day: int, period: int):
+        """
+        Every instructor/room at this slot failed for the first session of
+        the search. Before any solution (and so any diversity nogood)
+        exists, the subtree was explored under hard constraints and the
+        shared pins only, so the slot is dead for every worker.
+        """
+        if self.solutions or self.placed_sessions.bit_count() != self.root_placed or not self.keep_nogoods:
+            return
+        slot = day * self.PERIODS_PER_DAY + period
+        self.forbidden_starts[session_id] = self.forbidden_starts.get(session_id, 0) | (1 << slot)
+        self.exchange.publish_nogood(self.worker, session_id, slot)
+
+    def enumerate_solutions(self, k: int, min_distance: int, strategy: str = "section",
+                            max_time_seconds: int = 300, day_offset: int = 0) -> Dict:
+        """
+        Find up to k solutions pairwise at least min_distance sessions apart
+        in (session -> day/period) space. The search continues from each
+        solution instead of restarting, with diversity nogoods pruning
+        branches that stay too close to a recorded solution.
+
+        Args:
+            day_offset: stagger each session's day order by
+                        day_offset * session_id, so parallel workers start
+                        from different corners of the space (days are
+                        symmetric, a uniform rotation would not)
+        """
+        self.enumerating = True
+        self.exchange_seen = [0] * (self.exchange.workers if self.exchange is not None else 0)
+        self.solution_target = k
+        self.min_distance = min_distance
+        self.start_time = time.time()
+        self.deadline = self.start_time + max_time_seconds
+
+        session_ids = self._get_strategy_sessions(strategy)
+
+        for session_id in session_ids:
+            days = self.compiled_sessions[session_id].days
+            shift = day_offset * session_id % len(days)
+            days[:] = days[shift:] + days[:shift]
+
+        conflicts = self._apply_assignment_hints(session_ids)
+        timed_out = False
+        stopped = False
+        memory_exceeded = False
+        if not conflicts:
+            # Pins are the same in every worker, so nogoods learned below them hold for all
+            self.root_placed = self.placed_sessions.bit_count()
+            pinned = set(id(a) for a in self.timetable.values())
+            try:
+                if strategy == "section":
+                    # Section queues leave the anchors out: enumerate under each anchor placement in
+                    # turn (root nogoods are only learned when there are no anchors above the root).
+                    # A False return has unwound the section search; True means k solutions
+                    for _ in self._iter_anchor_placements(self._get_anchor_sessions()):
+                        if self.solve_by_section():
+                            break
+                else:
+                    self.solve_by_course(0, session_ids)
+            except SearchStopped:
+                stopped = True
+            except SearchTimeout:
+                timed_out = True
+            except SearchMemoryExceeded:
+                memory_exceeded = True
+            finally:
+                # The solutions are extracted already; leave only the pins placed
+                for assignment in list({id(a): a for a in self.timetable.values()}.values()):
+                    if id(assignment) not in pinned:
+                        self._remove_assignment(assignment)
+
+        return {
+            'solutions': [(slots, result) for slots, result in zip(self.own_solutions, self.solution_results)],
+            'stopped_early': stopped,
+            'nogoods_learned': sum(mask.bit_count() for mask in self.forbidden_starts.values()),
+            'pin_conflicts': conflicts,
+            'timed_out': timed_out,
+            'memory_exceeded': memory_exceeded,
+            'search_time': time.time() - self.start_time,
+            'attempts': self.attempts,
+            'backtracks': self.backtracks,
+            'peak_memory_mb': self.memory.peak_growth_mb()
+        }
+
+    # ==================== STRATEGY 1: SECTION-BY-SECTION ====================
+
+    def solve_by_section(self, section_idx: int = 0, queue_pos: int = 0) -> bool:
+        """
+        Backtracking by section (like C++ implementation).
+        For each section, schedule all its courses before moving to next section.
+        Walks the precomputed per-section queues, so picking the next session
+        is a single index step instead of rescanning the section's courses.
+        """
+        if section_idx >= len(self.sections):
+            return self._on_complete()  # All sections scheduled
+
+        queue = self.section_queues[section_idx]
+
+        if queue_pos >= len(queue) or self._is_section_complete(section_idx):
+            # Every session this section attends is placed (shared ones by earlier sections)
+            return self.solve_by_section(section_idx + 1)
+
+        session = self.compiled_sessions[queue[queue_pos]]
+        if self.placed_sessions >> session.session_id & 1:
+            # Pinned before search
+            return self.solve_by_section(section_idx, queue_pos + 1)
+
+        course = session.course
+        kind = session.kind
+        target_sections = session.sections
+
+        if not session.instructors:
+            print(f"No qualified instructor for {course.course_id} ({kind.type})")
+            return False
+
+        if not session.rooms:
+            print(f"No suitable room for {course.course_id} ({kind.type}, {session.students_count} students)")
+            return False
+
+        duration = session.duration
+        # Learned nogoods and the starts precedence rules out (one bitset, read once)
+        forbidden = self.forbidden_starts.get(session.session_id, 0) | self.precedence_blocked.get(session.session_id, 0)
+
+        instructor_busy = self.instructor_busy
+        instructor_limits = self.instructor_limits
+        room_busy = self.room_busy
+        travel_hard = self.travel_hard
+        room_count = len(session.rooms)
+
+        # Try all combinations. Sections/clusters are checked once per slot
+        # and the instructor once per instructor; combinations they rule out
+        # are counted as attempts without being tried one by one
+        for day in session.days:
+            for period in session.periods:
+                if forbidden and forbidden >> (day * self.PERIODS_PER_DAY + period) & 1:
+                    continue  # Learned nogood or precedence
+                mask = self._free_slot_mask(session.session_id, day, period)
+                if not mask:
+                    self._skip_attempts(len(session.instructors) * room_count)
+                for instructor_id in (session.instructors if mask else ()):
+                    if instructor_id != "N/A" and (instructor_busy.get(instructor_id, 0) & mask or (
+                            instructor_limits is not None and
+                            not self._instructor_within_limits(instructor_id, day, mask, session.session_id))):
+                        self._skip_attempts(room_count)
+                        continue
+                    for room_id in session.rooms:
+                        self.attempts += 1
+                        if not self.attempts & 0xFFF and self.deadline is not None:
+                            self._check_deadline()
+
+                        if room_id != "N/A" and room_busy.get(room_id, 0) & mask:
+                            continue
+                        if travel_hard and self._travel_cost(session.section_indices, instructor_id,
+                                                             day * self.PERIODS_PER_DAY + period, duration, room_id):
+                            continue
+
+                        if self.solutions and not self._keeps_diversity(session.session_id, day, period):
+                            continue
+
+                        # Place assignment
+                        assignment = Assignment(
+                            course_id=course.course_id,
+                            session_type=kind.type,
+                            sections=target_sections,
+                            instructor_id=instructor_id,
+                            room_id=room_id,
+                            day=day,
+                            period=period,
+                            duration=duration,
+                            session_id=session.session_id
+                        )
+                        self._place_assignment(assignment)
+
+                        # Recurse
+                        if self.solve_by_section(section_idx, queue_pos + 1):
+                            return True
+
+                        # Backtrack
+                        self.backtracks += 1
+                        self._remove_assignment(assignment)
+
+                if self.exchange is not None:
+                    self._learn_root_nogood(session.session_id, day, period)
+
+        # Failed to schedule this session type
+        return False
 
     # ==================== STRATEGY 2: COURSE-BY-COURSE ====================
 
-    def _get_all_sessions_to_schedule(self) -> List[Tuple[Course, CourseKind, List[str]]]:
-        """Generate all sessions that need to be scheduled"""
+    def _get_all_sessions_to_schedule(self) -> List[int]:
+        """Generate all sessions that need to be scheduled, as compiled session ids"""
         sessions = []
 
         for course in self.courses:
             for kind in course.kinds:
                 # Get all section groups for this course/kind
-                # Use first section as reference
-                reference_section = self.sections[0]
-                target_groups = self._get_target_sections(course, kind, reference_section)
+                if course.is_project:
+                    # One project session per group of the course's year/major
+                    target_groups = self._get_project_groups(course)
+                else:
+                    # Use first section as reference
+                    reference_section = self.sections[0]
+                    target_groups = self._get_target_sections(course, kind, reference_section)
 
                 for group in target_groups:
-                    sessions.append((course, kind, group))
+                    sessions.append(self._get_session_id(course, kind, group))
 
         return sessions
 
@@ -476,47 +2136,75 @@ class BacktrackingScheduler:
             all_sessions = self._get_all_sessions_to_schedule()
 
         if session_idx >= len(all_sessions):
-            return True  # All sessions scheduled
+            return self._on_complete()  # All sessions scheduled
 
-        course, kind, target_sections = all_sessions[session_idx]
+        session = self.compiled_sessions[all_sessions[session_idx]]
+        course = session.course
+        kind = session.kind
+        target_sections = session.sections
 
-        # Check if already scheduled
-        already_scheduled = all(
-            (course.course_id, kind.type) in self.scheduled_sessions[sid]
-            for sid in target_sections
-        )
-        if already_scheduled:
+        # Check if already scheduled (every attending section has the session bit set)
+        if self.placed_sessions >> session.session_id & 1:
             return self.solve_by_course(session_idx + 1, all_sessions)
 
-        students_count = sum(self.section_by_id[sid].students_count for sid in target_sections)
-
-        qualified_instructors = self._get_qualified_instructors(course.course_id, kind.type)
+        qualified_instructors = session.instructors
         if not qualified_instructors:
             print(f"No qualified instructor for {course.course_id} ({kind.type})")
             return False
 
-        if course.is_project:
-            suitable_rooms = ["N/A"]
-        else:
-            suitable_rooms = self._get_suitable_rooms(
-                kind.type, students_count, kind.lab_type, kind.ignore_capacity
-            )
-            if not suitable_rooms:
-                print(f"No suitable room for {course.course_id} ({kind.type}, {students_count} students)")
-                return False
-
-        duration = kind.length // 45
+        suitable_rooms = session.rooms
+        if not suitable_rooms:
+            print(f"No suitable room for {course.course_id} ({kind.type}, {session.students_count} students)")
+            return False
 
-        # Try all combinations
-        for day in range(self.DAYS):
-            for period in range(self.PERIODS_PER_DAY):
-                for instructor_id in qualified_instructors:
+        duration = session.duration
+        # Learned nogoods and the starts precedence rules out (one bitset, read once)
+        forbidden = self.forbidden_starts.get(session.session_id, 0) | self.precedence_blocked.get(session.session_id, 0)
+
+        instructor_busy = self.instructor_busy
+        instructor_limits = self.instructor_limits
+        room_busy = self.room_busy
+        travel_hard = self.travel_hard
+        room_pool = self.room_pool
+        # With the room pool, bucket-closed sessions take no room here (None):
+        # the slot only has to keep a room for everyone (_bind_rooms picks it)
+        pool_mask = room_pool.session_masks[session.session_id] if room_pool is not None else 0
+        if pool_mask:
+            suitable_rooms = (None,)
+        room_count = len(suitable_rooms)
+
+        # Try all combinations. Sections/clusters (and pooled rooms) are
+        # checked once per slot and the instructor once per instructor;
+        # combinations they rule out are counted as attempts without being
+        # tried one by one
+        for day in session.days:
+            for period in session.periods:
+                if forbidden and forbidden >> (day * self.PERIODS_PER_DAY + period) & 1:
+                    continue  # Learned nogood or precedence
+                mask = self._free_slot_mask(session.session_id, day, period)
+                if mask and pool_mask and not room_pool.admits(pool_mask, day * self.PERIODS_PER_DAY + period,
+                                                               duration):
+                    mask = 0
+                if not mask:
+                    self._skip_attempts(len(qualified_instructors) * room_count)
+                for instructor_id in (qualified_instructors if mask else ()):
+                    if instructor_id != "N/A" and (instructor_busy.get(instructor_id, 0) & mask or (
+                            instructor_limits is not None and
+                            not self._instructor_within_limits(instructor_id, day, mask, session.session_id))):
+                        self._skip_attempts(room_count)
+                        continue
                     for room_id in suitable_rooms:
                         self.attempts += 1
+                        if not self.attempts & 0xFFF and self.deadline is not None:
+                            self._check_deadline()
 
-                        if not self._is_valid_assignment(
-                                target_sections, day, period, duration, instructor_id, room_id
-                        ):
+                        if room_id is not None and room_id != "N/A" and room_busy.get(room_id, 0) & mask:
+                            continue
+                        if travel_hard and self._travel_cost(session.section_indices, instructor_id,
+                                                             day * self.PERIODS_PER_DAY + period, duration, room_id):
+                            continue
+
+                        if self.solutions and not self._keeps_diversity(session.session_id, day, period):
                             continue
 
                         # Place assignment
@@ -528,7 +2216,8 @@ class BacktrackingScheduler:
                             room_id=room_id,
                             day=day,
                             period=period,
-                            duration=duration
+                            duration=duration,
+                            session_id=session.session_id
                         )
                         self._place_assignment(assignment)
 
@@ -540,17 +2229,705 @@ class BacktrackingScheduler:
                         self.backtracks += 1
                         self._remove_assignment(assignment)
 
+                if self.exchange is not None:
+                    self._learn_root_nogood(session.session_id, day, period)
+
         return False
 
+    # ==================== LAZY ROOM BINDING ====================
+
+    def _enable_room_pool(self):
+        """
+        Bind rooms lazily in the course search (RoomPool). Call after the
+        hints: pinned sessions already hold their rooms, preferred rooms are
+        bound first when free. Off with building travel, which needs every
+        session's building while searching.
+        """
+        if self.travel is not None:
+            return
+        pool = RoomPool(self.rooms, self.TOTAL_SLOTS)
+        for session in self.compiled_sessions:
+            pool.session_masks.append(pool.mask_of(session.rooms))
+            order = sorted(session.rooms, key=lambda r: self.room_by_id[r].capacity if r in self.room_by_id else 0)
+            if session.session_id in self.preferred_slots:
+                self._move_to_front(order, session.rooms[0])
+            pool.bind_order.append(order)
+        for assignment in {id(a): a for a in self.timetable.values()}.values():
+            pool.take(assignment.room_id, assignment.day * self.PERIODS_PER_DAY + assignment.period,
+                      assignment.duration)
+        self.room_pool = pool
+
+    def _bind_room(self, assignment: Assignment, room_id: str):
+        first_slot = assignment.day * self.PERIODS_PER_DAY + assignment.period
+        self.room_pool.unplace(self.room_pool.session_masks[assignment.session_id], first_slot, assignment.duration)
+        assignment.room_id = room_id
+        self.room_busy[room_id] = self.room_busy.get(room_id, 0) | self._slot_mask(
+            assignment.day, assignment.period, assignment.duration)
+        self.room_pool.take(room_id, first_slot, assignment.duration)
+
+    def _unbind_room(self, assignment: Assignment):
+        first_slot = assignment.day * self.PERIODS_PER_DAY + assignment.period
+        self.room_pool.release(assignment.room_id, first_slot, assignment.duration)
+        self.room_busy[assignment.room_id] &= ~self._slot_mask(assignment.day, assignment.period, assignment.duration)
+        assignment.room_id = None
+        self.room_pool.place(self.room_pool.session_masks[assignment.session_id], first_slot, assignment.duration)
+
+    def _bind_rooms(self, best_effort: bool = False) -> bool:
+        """
+        Give every session the pool placed a concrete room, day by day.
+        Returns False with nothing bound when some day has no binding;
+        best_effort binds what it can instead and returns True.
+        """
+        by_day = defaultdict(list)
+        for assignment in {id(a): a for a in self.timetable.values()}.values():
+            if assignment.room_id is None:
+                by_day[assignment.day].append(assignment)
+
+        bound = []
+        for day in sorted(by_day):
+            assignments = sorted(by_day[day], key=lambda a: (a.period, -a.duration,
+                                                             len(self.room_pool.bind_order[a.session_id])))
+            if best_effort:
+                for assignment in assignments:
+                    room_id = self._first_free_room(assignment)
+                    if room_id is not None:
+                        self._bind_room(assignment, room_id)
+            elif not self._bind_day(assignments, bound):
+                for assignment in reversed(bound):
+                    self._unbind_room(assignment)
+                return False
+        return True
+
+    def _first_free_room(self, assignment: Assignment) -> Optional[str]:
+        mask = self._slot_mask(assignment.day, assignment.period, assignment.duration)
+        room_busy = self.room_busy
+        return next((room_id for room_id in self.room_pool.bind_order[assignment.session_id]
+                     if not room_busy.get(room_id, 0) & mask), None)
+
+    def _bind_day(self, assignments: List[Assignment], bound: List[Assignment], node_limit: int = 20000) -> bool:
+        """
+        One pass in start order giving each session its smallest free room.
+        When that gets stuck (the per-slot counters cannot see that a
+        90-minute session needs the same room in both periods), a
+        depth-first search over the day takes over; rooms of one bucket
+        with the same occupancy that day are tried once.
+        """
+        start = len(bound)
+        for assignment in assignments:
+            room_id = self._first_free_room(assignment)
+            if room_id is None:
+                break
+            self._bind_room(assignment, room_id)
+            bound.append(assignment)
+        else:
+            return True
+        while len(bound) > start:
+            self._unbind_room(bound.pop())
+
+        room_busy = self.room_busy
+        bucket_of_room = self.room_pool.bucket_of_room
+        day_shift = assignments[0].day * self.PERIODS_PER_DAY
+        day_bits = (1 << self.PERIODS_PER_DAY) - 1
+        nodes = 0
+
+        def bind_from(i: int) -> bool:
+            nonlocal nodes
+            if i == len(assignments):
+                return True
+            nodes += 1
+            if nodes > node_limit:
+                return False
+            assignment = assignments[i]
+            mask = self._slot_mask(assignment.day, assignment.period, assignment.duration)
+            tried = set()
+            for room_id in self.room_pool.bind_order[assignment.session_id]:
+                busy = room_busy.get(room_id, 0)
+                key = (bucket_of_room[room_id], busy >> day_shift & day_bits)
+                if busy & mask or key in tried:
+                    continue
+                tried.add(key)
+                self._bind_room(assignment, room_id)
+                bound.append(assignment)
+                if bind_from(i + 1):
+                    return True
+                self._unbind_room(bound.pop())
+            return False
+
+        return bind_from(0)
+
+    # ==================== STRATEGY 3: DAY-THEN-PERIOD ====================
+
+    def _assign_days(self, session_ids: List[int], day_capacity: List[int]) -> Optional[Dict[int, int]]:
+        """
+        Phase 1: give every session a day. Sessions are taken most
+        constrained first and put on the feasible day with the lowest load,
+        so the week stays balanced. Instructors and rooms are not chosen
+        yet, so a session spreads its periods evenly over its qualified
+        instructors and suitable rooms. A day is feasible when no section,
+        student cluster, instructor or room goes past day_capacity[day]
+        periods. Pinned sessions keep their day, preferred ones get theirs
+        when it is feasible. Precedence partners keep their day order.
+        Sections reach their minimum days per week here: a session may only
+        join a day the section already uses while its sessions still
+        unassigned can cover the days missing (the day workers do not see
+        the week).
+        """
+        section_load = [[0] * self.DAYS for _ in self.sections]
+        cluster_load = [[0] * self.DAYS for _ in self.cluster_busy]
+        instructor_load = defaultdict(lambda: [0.0] * self.DAYS)
+        room_load = defaultdict(lambda: [0.0] * self.DAYS)
+        day_of = {}
+        section_days = [0] * len(self.sections)  # section index -> bitset of days in use
+        section_left = [0] * len(self.sections)  # section index -> sessions without a day
+        for session_id in session_ids:
+            for idx in self.compiled_sessions[session_id].section_indices:
+                section_left[idx] += 1
+        # Workload limits on periods per day cap the loads too
+        section_periods = self.section_limits[0] if self.section_limits is not None else self.PERIODS_PER_DAY
+        instructor_periods = self.instructor_limits[0] if self.instructor_limits is not None else self.PERIODS_PER_DAY
+
+        def order(session_id):
+            # Sessions that must follow another go after every session that may precede them
+            session = self.compiled_sessions[session_id]
+            follows = any(not other_follows for _, other_follows, _, _ in self.precedence_links.get(session_id, ()))
+            return (follows, -len(session.sections) * session.duration, len(session.rooms), session_id)
+
+        for session_id in sorted(session_ids, key=order):
+            session = self.compiled_sessions[session_id]
+            # Unsupervised graduation projects hold no instructor and no room
+            instructors = [i for i in session.instructors if i != "N/A"]
+            instructor_share = session.duration / len(instructors) if instructors else 0
+            rooms = [r for r in session.rooms if r != "N/A"]
+            room_share = session.duration / len(rooms) if rooms else 0
+            # Sessions others must follow lean to early days, keeping later ones open
+            leads = any(other_follows and other not in day_of and not same_day
+                        for other, other_follows, _, same_day in self.precedence_links.get(session_id, ()))
+
+            best_day, best_load = None, None
+            for day in session.days:
+                if self.precedence_links and not self._precedence_allows_day(session_id, day, day_of):
+                    continue
+                limit = max(day_capacity[day], session.duration)  # A full-day session still fits an empty day
+                loads = [section_load[idx][day] + session.duration for idx in session.section_indices]
+                if max(loads, default=0) > min(limit, section_periods):
+                    continue
+                if any(section_days[idx] >> day & 1 and
+                       section_days[idx].bit_count() + section_left[idx] - 1 < self.section_min_days[idx]
+                       for idx in session.section_indices):
+                    continue  # The section would be left short of its minimum days
+                loads += [cluster_load[c][day] + session.duration for c in session.cluster_indices]
+                loads += [instructor_load[i][day] + instructor_share for i in instructors]
+                if max(loads) > limit:
+                    continue
+                if instructors and min(instructor_load[i][day] for i in instructors) + instructor_share > instructor_periods:
+                    continue
+                if rooms and min(room_load[r][day] for r in rooms) + room_share > limit:
+                    continue
+
+                load = max(loads)
+                if leads:
+                    load += day
+                if self.placed_sessions >> session_id & 1 or self.preferred_slots.get(session_id, (None,))[0] == day:
+                    load = -1  # Keep pinned and preferred days
+                if best_load is None or load < best_load:
+                    best_day, best_load = day, load
+
+            if best_day is None:
+                print(f"No day fits {session.course.course_id} ({session.kind.type}) for {', '.join(session.sections)}")
+                return None
+
+            day_of[session_id] = best_day
+            for idx in session.section_indices:
+                section_load[idx][best_day] += session.duration
+                section_days[idx] |= 1 << best_day
+                section_left[idx] -= 1
+            for c in session.cluster_indices:
+                cluster_load[c][best_day] += session.duration
+            for i in instructors:
+                instructor_load[i][best_day] += instructor_share
+            for r in rooms:
+                room_load[r][best_day] += room_share
+
+        return day_of
+
+    def solve_by_day(self, session_ids: List[int], max_time_seconds: int = 300, rounds: int = 4) -> bool:
+        """
+        Two-level decomposition. Phase 1 assigns days (_assign_days); phase 2
+        solves each day's periods, instructors and rooms as an independent
+        subproblem, one worker process per day. Days share no constraint
+        once sessions are split, so the subproblems never interact. When a
+        day fails, its capacity is lowered by one period and phase 1 is
+        rerun, pushing sessions onto the other days.
+        """
+        import multiprocessing
+
+        deadline = time.time() + max_time_seconds
+        day_capacity = [self.PERIODS_PER_DAY] * self.DAYS
+
+        for round_idx in range(rounds):
+            self._check_preemption()
+            self._check_memory()
+            day_of = self._assign_days(session_ids, day_capacity)
+            if day_of is None:
+                return False
+
+            sessions_by_day = defaultdict(list)
+            for session_id in session_ids:
+                sessions_by_day[day_of[session_id]].append(session_id)
+
+            remaining = max(deadline - time.time(), 1)
+            jobs = [(self.data, day, sessions_by_day[day], remaining) for day in range(self.DAYS)]
+            processes = self.memory.workers_within_budget(self.DAYS)
+            with span("day_round", round=round_idx + 1), multiprocessing.Pool(processes) as pool:
+                results = pool.map(_solve_day_worker, jobs)
+
+            failed = [r['day'] for r in results if r['placements'] is None]
+            self.day_stats.append([{k: r[k] for k in ('day', 'sessions', 'attempts', 'solve_time')}
+                                   for r in results])
+            for r in results:
+                self.attempts += r['attempts']
+                self.backtracks += r['backtracks']
+
+            if not failed:
+                for placement in (p for r in results for p in r['placements']):
+                    session = self.compiled_sessions[placement['session_id']]
+                    if self.placed_sessions >> session.session_id & 1:
+                        continue  # Pinned
+                    self._place_assignment(Assignment(
+                        course_id=session.course.course_id,
+                        session_type=session.kind.type,
+                        sections=session.sections,
+                        duration=session.duration,
+                        **placement
+                    ))
+                if self.instructor_limits is not None and self._instructor_days_short():
+                    # Each day picked its instructors alone; the week can come out short
+                    print(f"Instructors are {self._instructor_days_short()} day(s) short of their minimum")
+                    return False
+                return True
+
+            print(f"Round {round_idx + 1}: days {', '.join(self.DAY_NAMES[d] for d in failed)} failed, rebalancing")
+            if time.time() > deadline:
+                break
+            for day in failed:
+                day_capacity[day] = max(day_capacity[day] - 1, 2)
+
+        return False
+
+    # ==================== STRATEGY 4: ISLAND GENETIC ALGORITHM ====================
+
+    def _ga_order(self, session_ids: List[int]) -> List[int]:
+        """Decode order: fewest instructor/room options first, then the largest sessions"""
+        return sorted(
+            (s for s in session_ids if not self.placed_sessions >> s & 1),
+            key=lambda s: (len(self.compiled_sessions[s].instructors) * len(self.compiled_sessions[s].rooms),
+                           -self.compiled_sessions[s].duration * len(self.compiled_sessions[s].sections)))
+
+    def _random_chromosome(self, order: List[int], rng: random.Random) -> List[int]:
+        """Flat genes, three per session in decode order: slot, instructor index, room index"""
+        slots = self.DAYS * self.PERIODS_PER_DAY
+        genes = []
+        for session_id in order:
+            session = self.compiled_sessions[session_id]
+            genes += [rng.randrange(slots), rng.randrange(len(session.instructors)),
+                      rng.randrange(len(session.rooms))]
+        return genes
+
+    def _idle_periods(self, mask: int) -> int:
+        """Idle periods between the first and last busy period, summed over days"""
+        idle = 0
+        day_mask = (1 << self.PERIODS_PER_DAY) - 1
+        for day in range(self.DAYS):
+            bits = (mask >> (day * self.PERIODS_PER_DAY)) & day_mask
+            if bits:
+                idle += bits.bit_length() - (bits & -bits).bit_length() + 1 - bits.bit_count()
+        return idle
+
+    def _decode_chromosome(self, order: List[int], genes: List[int]) -> Tuple[Tuple[int, int], List[Assignment]]:
+        """
+        Place the sessions in order at their genes. A gene that does not fit
+        is repaired to the next slot where the sections are free, taking the
+        first free instructor and room counting from the gene's own; the
+        repaired values are written back so children inherit them.
+        Returns the fitness (unplaced sessions plus instructor days short of
+        the workload minimum, idle periods plus the soft travel penalty) and
+        the placed assignments, which stay in the state.
+        """
+        slots = self.DAYS * self.PERIODS_PER_DAY
+        placed = []
+        unplaced = 0
+
+        for i, session_id in enumerate(order):
+            session = self.compiled_sessions[session_id]
+            duration = session.duration
+            instructors = session.instructors
+            rooms = session.rooms
+            slot_gene, instructor_gene, room_gene = genes[3 * i], genes[3 * i + 1], genes[3 * i + 2]
+            blocked = self.precedence_blocked.get(session_id, 0)
+
+            for offset in range(slots):
+                slot = (slot_gene + offset) % slots
+                day, period = divmod(slot, self.PERIODS_PER_DAY)
+                self.attempts += 1
+                if (duration == 2 and period % 2 != 0) or period + duration > self.PERIODS_PER_DAY:
+                    continue
+                if blocked >> slot & 1:
+                    continue
+                mask = ((1 << duration) - 1) << slot
+                if any(self.section_busy[idx] & mask for idx in session.section_indices):
+                    continue
+                if any(self.cluster_busy[c] & mask for c in session.cluster_indices):
+                    continue
+                if self.section_limits is not None and not self._sections_within_limits(session_id, day, mask):
+                    continue
+
+                instructor = next(
+                    (j % len(instructors) for j in range(instructor_gene, instructor_gene + len(instructors))
+                     if instructors[j % len(instructors)] == "N/A"
+                     or not self.instructor_busy.get(instructors[j % len(instructors)], 0) & mask
+                     and (self.instructor_limits is None
+                          or self._instructor_within_limits(instructors[j % len(instructors)], day, mask,
+                                                            session_id))), None)
+                if instructor is None:
+                    continue
+                room = next(
+                    (j % len(rooms) for j in range(room_gene, room_gene + len(rooms))
+                     if rooms[j % len(rooms)] == "N/A" or not self.room_busy.get(rooms[j % len(rooms)], 0) & mask
+                     and not (self.travel_hard and self._travel_cost(session.section_indices, instructors[instructor],
+                                                                     slot, duration, rooms[j % len(rooms)]))),
+                    None)
+                if room is None:
+                    continue
+
+                genes[3 * i:3 * i + 3] = [slot, instructor, room]
+                assignment = Assignment(
+                    course_id=session.course.course_id,
+                    session_type=session.kind.type,
+                    sections=session.sections,
+                    instructor_id=instructors[instructor],
+                    room_id=rooms[room],
+                    day=day,
+                    period=period,
+                    duration=duration,
+                    session_id=session_id
+                )
+                self._place_assignment(assignment)
+                placed.append(assignment)
+                break
+            else:
+                unplaced += 1
+        if self.instructor_limits is not None:
+            unplaced += self._instructor_days_short()  # Counted like unplaced sessions
+
+        idle = sum(self._idle_periods(mask) for mask in self.section_busy)
+        idle += sum(self._idle_periods(mask) for mask in self.instructor_busy.values())
+        if self.travel is not None:
+            idle += self.travel_penalty  # Soft building travel (0 in hard mode)
+        return (unplaced, idle), placed
+
+    def _evaluate_chromosome(self, order: List[int], genes: List[int]) -> Tuple[int, int]:
+        """Decode (repairing genes in place), score, and undo the placements"""
+        fitness, placed = self._decode_chromosome(order, genes)
+        for assignment in reversed(placed):
+            self._remove_assignment(assignment)
+        return fitness
+
+    def _evolve_island(self, order: List[int], population: Optional[List], population_size: int,
+                       rng: random.Random, max_time_seconds: float) -> Dict:
+        """
+        Generational GA with elitism for one island epoch. Crossover takes
+        whole days from one parent (sessions the parent put on those days)
+        and the rest from the other, so feasible day-blocks survive;
+        mutation re-rolls a few sessions; decoding repairs the child.
+        population: list of (fitness, genes), or None to start from random
+        """
+        start_time = time.time()
+        deadline = start_time + max_time_seconds
+        evaluations = 0
+
+        if population is None:
+            population = []
+            for _ in range(population_size):
+                genes = self._random_chromosome(order, rng)
+                population.append((self._evaluate_chromosome(order, genes), genes))
+                evaluations += 1
+
+        def tournament():
+            return min(rng.sample(population, 3), key=lambda p: p[0])[1]
+
+        generations = 0
+        while time.time() < deadline:
+            population.sort(key=lambda p: p[0])
+            next_population = population[:2]  # Elites
+            while len(next_population) < population_size:
+                parent_a, parent_b = tournament(), tournament()
+                days_from_a = rng.getrandbits(self.DAYS)
+                child = []
+                for i in range(0, len(parent_a), 3):
+                    day = parent_a[i] // self.PERIODS_PER_DAY
+                    child += parent_a[i:i + 3] if days_from_a >> day & 1 else parent_b[i:i + 3]
+
+                for _ in range(rng.randint(1, 3)):
+                    i = rng.randrange(len(order))
+                    session = self.compiled_sessions[order[i]]
+                    child[3 * i:3 * i + 3] = [rng.randrange(self.DAYS * self.PERIODS_PER_DAY),
+                                              rng.randrange(len(session.instructors)),
+                                              rng.randrange(len(session.rooms))]
+
+                next_population.append((self._evaluate_chromosome(order, child), child))
+                evaluations += 1
+            population = next_population
+            generations += 1
+
+        population.sort(key=lambda p: p[0])
+        elapsed = time.time() - start_time
+        return {
+            'population': population,
+            'generations': generations,
+            'evaluations': evaluations,
+            'time': elapsed
+        }
+
+    def solve_by_ga(self, session_ids: List[int], max_time_seconds: int = 300, islands: Optional[int] = None,
+                    population_size: int = 20, epoch_seconds: float = 2.0, migrants: int = 2,
+                    stall_epochs: int = 10) -> bool:
+        """
+        Island-model GA, one worker process per island. Islands evolve
+        independently for an epoch, then the best `migrants` of each island
+        replace the worst of the next one (ring). Fitness is (unplaced
+        sessions, idle periods of sections and instructors), compared
+        lexicographically. Runs until the deadline or until the best
+        fitness has not improved for stall_epochs epochs; succeeds if the
+        best timetable places every session.
+        """
+        import multiprocessing
+
+        deadline = time.time() + max_time_seconds
+        order = self._ga_order(session_ids)
+
+        # Genes pick an instructor and a room by index; a session without either can never be placed
+        for session_id in order:
+            session = self.compiled_sessions[session_id]
+            if not session.instructors:
+                print(f"No qualified instructor for {session.course.course_id} ({session.kind.type})")
+                return False
+            if not session.rooms:
+                print(f"No suitable room for {session.course.course_id} ({session.kind.type}, "
+                      f"{session.students_count} students)")
+                return False
+
+        islands = self.memory.workers_within_budget(islands or multiprocessing.cpu_count())
+        populations = [None] * islands
+        best = None
+        stalled = 0
+        epoch = 0
+        island_stats = [{'island': i, 'evaluations': 0, 'generations': 0, 'time': 0.0} for i in range(islands)]
+
+        with multiprocessing.Pool(islands, initializer=_init_ga_worker, initargs=(self.data,)) as pool:
+            while stalled < stall_epochs:
+                self._check_preemption()
+                if self.memory.over_budget():
+                    self.memory.degrade("GA stopped early with its best timetable so far")
+                    break
+                remaining = deadline - time.time()
+                if remaining <= 0:
+                    break
+                jobs = [(island, populations[island], epoch * islands + island, population_size,
+                         min(epoch_seconds, remaining)) for island in range(islands)]
+                with span("ga_epoch", epoch=epoch + 1):
+                    results = pool.map(_ga_island_worker, jobs)
+
+                for island, r in enumerate(results):
+                    populations[island] = r['population']
+                    stats = island_stats[island]
+                    for key in ('evaluations', 'generations', 'time'):
+                        stats[key] += r[key]
+                    self.attempts += r['attempts']
+
+                # Migration: elites of each island replace the worst of the next
+                for island in range(islands):
+                    target = populations[(island + 1) % islands]
+                    target[-migrants:] = [(fitness, list(genes)) for fitness, genes in populations[island][:migrants]]
+                    target.sort(key=lambda p: p[0])
+
+                epoch_best = min((p[0] for p in populations), key=lambda p: p[0])
+                if best is None or epoch_best[0] < best[0]:
+                    best = (epoch_best[0], list(epoch_best[1]))
+                    stalled = 0
+                else:
+                    stalled += 1
+                epoch += 1
+                print(f"Epoch {epoch}: best {best[0][0]} unplaced, {best[0][1]} idle periods")
+                if best[0] == (0, 0):
+                    break  # Cannot improve
+
+        for stats in island_stats:
+            stats['evaluations_per_second'] = stats['evaluations'] / max(stats['time'], 1e-9)
+        self.ga_stats = {
+            'epochs': epoch,
+            'islands': island_stats,
+            'best_unplaced': best[0][0] if best else None,
+            'best_idle_periods': best[0][1] if best else None
+        }
+
+        if best is None:
+            return False
+        fitness, _ = self._decode_chromosome(order, best[1])
+        return fitness[0] == 0
+
+    # ==================== COOPERATIVE SEARCH ====================
+
+    def _search_order(self, strategy: str, session_ids: List[int]) -> List[int]:
+        """
+        Flat session order equivalent to the recursive strategies: the
+        section queues walked in turn (sessions shared with an earlier
+        section appear once) or the course order, anchors first.
+        """
+        if strategy == "section":
+            session_ids = [s for queue in self.section_queues for s in queue]
+        order = [s for s in self._get_anchor_sessions()]
+        seen = set(order)
+        for session_id in session_ids:
+            if session_id not in seen:
+                seen.add(session_id)
+                order.append(session_id)
+        return [s for s in order if not self.placed_sessions >> s & 1]
+
+    def iter_search(self, order: List[int], nodes_per_step: int = 4096):
+        """
+        Generator form of the chronological search over `order`, with an
+        explicit stack instead of recursion. Runs at most nodes_per_step
+        attempts per resumption, then yields a progress dict; the return
+        value (StopIteration.value) is True when everything is placed.
+        Closing the generator cancels at once and unwinds the placements.
+        """
+        start_time = time.time()
+        frames = []  # per depth: [session, candidate iterator, placed assignment or None]
+        budget = nodes_per_step
+
+        def push(session_id):
+            session = self.compiled_sessions[session_id]
+            candidates = itertools.product(session.days, session.periods, session.instructors, session.rooms)
+            frames.append([session, candidates, None])
+
+        try:
+            if not order:
+                return self._on_complete()
+            push(order[0])
+
+            while frames:
+                frame = frames[-1]
+                session, candidates, assignment = frame
+                if assignment is not None:
+                    # Back from a failed subtree
+                    self.backtracks += 1
+                    self._remove_assignment(assignment)
+                    frame[2] = None
+
+                forbidden = self.forbidden_starts.get(session.session_id, 0) | \
+                    self.precedence_blocked.get(session.session_id, 0)
+                for day, period, instructor_id, room_id in candidates:
+                    if forbidden and forbidden >> (day * self.PERIODS_PER_DAY + period) & 1:
+                        continue
+                    self.attempts += 1
+                    budget -= 1
+                    if not budget:
+                        budget = nodes_per_step
+                        yield {
+                            'attempts': self.attempts,
+                            'backtracks': self.backtracks,
+                            'placed': len(frames) - 1,
+                            'total': len(order),
+                            'elapsed': time.time() - start_time
+                        }
+
+                    if not self._is_valid_session(session.session_id, day, period, instructor_id, room_id):
+                        continue
+                    if self.solutions and not self._keeps_diversity(session.session_id, day, period):
+                        continue
+
+                    frame[2] = Assignment(
+                        course_id=session.course.course_id,
+                        session_type=session.kind.type,
+                        sections=session.sections,
+                        instructor_id=instructor_id,
+                        room_id=room_id,
+                        day=day,
+                        period=period,
+                        duration=session.duration,
+                        session_id=session.session_id
+                    )
+                    self._place_assignment(frame[2])
+                    break
+
+                if frame[2] is None:
+                    frames.pop()  # Exhausted: backtrack into the parent
+                elif len(frames) < len(order):
+                    push(order[len(frames)])
+                elif self._on_complete():
+                    return True
+                # else enumerating: resume this frame for the next solution
+
+            return False
+        except GeneratorExit:
+            for _, _, assignment in reversed(frames):
+                if assignment is not None:
+                    self._remove_assignment(assignment)
+            raise
+
+    def iter_solve(self, strategy: str = "section", nodes_per_step: int = 4096, columnar: bool = False):
+        """
+        Cooperative solve: yields {'event': 'progress', ...} every
+        nodes_per_step attempts and finally {'event': 'result', 'result': ...}.
+        Lets a single-threaded loop interleave several solves and stream
+        their progress; close() to cancel. Strategies "section" and "course".
+        """
+        start_time = time.time()
+        session_ids = self._get_strategy_sessions(strategy)
+        conflicts = self._apply_assignment_hints(session_ids)
+
+        success = False
+        if not conflicts:
+            search = self.iter_search(self._search_order(strategy, session_ids), nodes_per_step)
+            try:
+                while True:
+                    try:
+                        progress = next(search)
+                    except StopIteration as stop:
+                        success = stop.value
+                        break
+                    progress['event'] = 'progress'
+                    yield progress
+            finally:
+                search.close()  # Cancelled: unwind now rather than at garbage collection
+
+        solve_time = time.time() - start_time
+        if success:
+            result = self._extract_solution(solve_time, columnar)
+        else:
+            result = {
+                'status': 'failed',
+                'message': 'Pinned assignments cannot be placed' if conflicts else 'No solution found',
+                'pin_conflicts': conflicts,
+                'solve_time': solve_time,
+                'attempts': self.attempts,
+                'backtracks': self.backtracks
+            }
+        result['strategy'] = strategy
+        yield {'event': 'result', 'result': result}
+
     # ==================== SOLVE ENTRY POINTS ====================
 
-    def solve(self, strategy: str = "section", max_time_seconds: int = 300) -> Dict:
+    def solve(self, strategy: str = "section", max_time_seconds: int = 300,
+              columnar: bool = False) -> Dict:
         """
         Main solve entry point
 
         Args:
-            strategy: "section" or "course"
-            max_time_seconds: Timeout (not enforced, just for reference)
+            strategy: "section", "course", "day", "ga", or "auto" to pick by
+                      predicted solve time (selector.py)
+            max_time_seconds: Timeout, shared between anchor rounds (section/course), days or GA epochs
+            columnar: Return the schedule as a ScheduleColumns
         """
         print(f"\n{'='*60}")
         print(f"STARTING BACKTRACKING SCHEDULER")
@@ -559,10 +2936,44 @@ class BacktrackingScheduler:
 
         start_time = time.time()
 
-        if strategy == "section":
-            success = self.solve_by_section()
-        else:
-            success = self.solve_by_course()
+        if strategy == "auto":
+            with span("instance_features"):
+                self.instance_features = instance_features(self.data)
+            self.strategy_selection = select_strategy(self.instance_features)
+            strategy = self.strategy_selection['strategy']
+            print(f"Auto-selected strategy: {strategy} (predicted "
+                  f"{self.strategy_selection['predicted_seconds'][strategy]:.2f}s)")
+
+        with span("expand_sessions", strategy=strategy):
+            session_ids = self._get_strategy_sessions(strategy)
+            anchors = self._get_anchor_sessions() if strategy != "day" else []
+
+        with span("apply_hints"):
+            conflicts = self._apply_assignment_hints(session_ids)
+        preempted = False
+        memory_exceeded = False
+        with span("search", strategy=strategy):
+            try:
+                if conflicts:
+                    for conflict in conflicts:
+                        print(conflict)
+                    success = False
+                elif strategy == "section":
+                    success = self._solve_with_anchors(self.solve_by_section, anchors, max_time_seconds)
+                elif strategy == "day":
+                    success = self.solve_by_day(session_ids, max_time_seconds)
+                elif strategy == "ga":
+                    success = self.solve_by_ga(session_ids, max_time_seconds)
+                else:
+                    self._enable_room_pool()
+                    success = self._solve_with_anchors(partial(self.solve_by_course, 0, session_ids),
+                                                       anchors, max_time_seconds)
+            except SearchPreempted:
+                success = False
+                preempted = True
+            except SearchMemoryExceeded:
+                success = False
+                memory_exceeded = True
 
         solve_time = time.time() - start_time
 
@@ -575,22 +2986,70 @@ class BacktrackingScheduler:
         print(f"Backtracks: {self.backtracks:,}")
 
         if success:
-            return self._extract_solution(solve_time)
+            with span("extract_solution"):
+                result = self._extract_solution(solve_time, columnar)
+        elif preempted:
+            result = {
+                'status': 'preempted',
+                'message': 'Solve stopped to free its worker for a higher-priority job',
+                'solve_time': solve_time,
+                'attempts': self.attempts,
+                'backtracks': self.backtracks
+            }
+        elif memory_exceeded:
+            columns = self.partial_columns
+            result = {
+                'status': 'partial',
+                'message': 'Memory budget reached; schedule holds the sessions placed so far',
+                'solve_time': solve_time,
+                'total_sessions': len(columns),
+                'schedule': columns if columnar else columns.to_rows(self.data),
+                'unplaced_sessions': self.partial_unplaced,
+                'attempts': self.attempts,
+                'backtracks': self.backtracks
+            }
+        elif conflicts:
+            result = {
+                'status': 'failed',
+                'message': 'Pinned assignments cannot be placed',
+                'pin_conflicts': conflicts,
+                'solve_time': solve_time,
+                'attempts': self.attempts,
+                'backtracks': self.backtracks
+            }
         else:
-            return {
+            result = {
                 'status': 'failed',
                 'message': 'No solution found',
+                'exhausted': self.search_exhausted,  # True: the whole space was searched (infeasible)
                 'solve_time': solve_time,
                 'attempts': self.attempts,
                 'backtracks': self.backtracks
             }
 
-    def _extract_solution(self, solve_time: float) -> Dict:
-        """Extract solution from timetable with new format"""
-        schedule = []
-        seen = set()
+        if self.hint_warnings:
+            result['hint_warnings'] = self.hint_warnings
+        result['memory'] = self.memory.report()
+        result['peak_memory_mb'] = result['memory']['peak_delta_mb']
 
-        DAY_NAMES = ["Sunday", "Monday", "Tuesday", "Wednesday", "Thursday"]
+        result['strategy'] = strategy
+        if self.strategy_selection:
+            result['instance_features'] = self.instance_features
+            result['strategy_selection'] = self.strategy_selection
+        return result
+
+    def _extract_columns(self) -> ScheduleColumns:
+        """Placed assignments as one ScheduleColumns row per (session, section)"""
+        course_index = {c.course_id: i for i, c in enumerate(self.courses)}
+        session_types = ["Lecture", "Tut", "Lab"]
+        instructor_ids = [i.instr_id for i in self.instructors] + ["N/A"]
+        instructor_index = {instr_id: i for i, instr_id in enumerate(instructor_ids)}
+        room_ids = [r.room_id for r in self.rooms] + ["N/A"]
+        room_index = {room_id: i for i, room_id in enumerate(room_ids)}
+
+        columns = ScheduleColumns([c.course_id for c in self.courses], session_types,
+                                  [s.section_id for s in self.sections], instructor_ids, room_ids)
+        seen = set()
 
         for (section_id, day, period), assignment in self.timetable.items():
             key = (assignment.course_id, assignment.session_type,
@@ -599,72 +3058,28 @@ class BacktrackingScheduler:
                 continue
             seen.add(key)
 
-            # Create one entry per section in the assignment
+            # Create one row per section in the assignment
             for section_id in assignment.sections:
-                section = self.section_by_id[section_id]
-                group = self.group_by_id[section.group_id]
-                course = self.course_by_id[assignment.course_id]
-                room = self.room_by_id.get(assignment.room_id, None)
-                instructor = self.instructor_by_id[assignment.instructor_id]
-
-                # Calculate time slot
-                start_time_minutes = assignment.period * 45
-                end_time_minutes = start_time_minutes + (assignment.duration * 45)
-
-                start_hour = start_time_minutes // 60
-                start_minute = start_time_minutes % 60
-                end_hour = end_time_minutes // 60
-                end_minute = end_time_minutes % 60
-
-                time_slot = f"{start_hour:02d}:{start_minute:02d} - {end_hour:02d}:{end_minute:02d}"
-
-                # Determine period alignment
-                period_alignment = "Any"
-                if assignment.duration == 2:
-                    period_alignment = "Even" if assignment.period % 2 == 0 else "Odd"
-
-                # Determine section display
-                section_display = section_id.split('-')[-1]
-
-                # Determine lab type and physics lab status
-                lab_type = None
-                is_physics_lab = False
-                if assignment.session_type == "Lab":
-                    # Find the course kind to get lab_type
-                    for kind in course.kinds:
-                        if kind.type == "Lab":
-                            lab_type = kind.lab_type
-                            is_physics_lab = (lab_type == "physics lab")
-                            break
+                columns.append(
+                    course_index[assignment.course_id],
+                    session_types.index(assignment.session_type),
+                    self.section_index[section_id],
+                    instructor_index[assignment.instructor_id],
+                    room_index[assignment.room_id],
+                    day, period, assignment.period, assignment.duration
+                )
 
-                schedule.append({
-                    'instance_id': f"{assignment.course_id}_{section_id}_{assignment.session_type.upper()}",
-                    'course_id': assignment.course_id,
-                    'course_name': course.name,
-                    'type': assignment.session_type,
-                    'meeting_type': assignment.session_type,
-                    'day': DAY_NAMES[day],
-                    'period': period + 1,  # Convert to 1-based
-                    'start_period': assignment.period + 1,  # Convert to 1-based
-                    'end_period': assignment.period + assignment.duration,  # Already 1-based
-                    'time_slot': time_slot,
-                    'duration_periods': assignment.duration,
-                    'duration_minutes': assignment.duration * 45,
-                    'room_id': assignment.room_id,
-                    'room_type': room.type if room else "N/A",
-                    'building': room.building if room else "N/A",
-                    'instructor_id': assignment.instructor_id,
-                    'instructor_name': instructor.name,
-                    'group_id': section.group_id,
-                    'section_id': section_id,
-                    'section_display': section_display,
-                    'year': group.year,
-                    'lab_type': lab_type,
-                    'is_physics_lab': is_physics_lab,
-                    'period_alignment': period_alignment
-                })
+        return columns
 
-        return {
+    def _extract_solution(self, solve_time: float, columnar: bool = False) -> Dict:
+        """
+        Extract solution from timetable with new format. With columnar=True
+        'schedule' is a ScheduleColumns; call to_rows(data) to get entries.
+        """
+        columns = self._extract_columns()
+        schedule = columns if columnar else columns.to_rows(self.data)
+
+        result = {
             'status': 'success',
             'message': 'Solution found',
             'solve_time': solve_time,
@@ -674,21 +3089,78 @@ class BacktrackingScheduler:
             'backtracks': self.backtracks
         }
 
+        if self.day_stats:
+            result['day_stats'] = self.day_stats
+        if self.anchor_stats:
+            result['anchor_rounds'] = self.anchor_stats
+        if self.ga_stats:
+            result['ga_stats'] = self.ga_stats
+        if self.travel is not None:
+            result['building_travel'] = {'mode': self.travel[0], 'penalty': self.travel_penalty}
+
+        if self.preferred_slots or self.pinned_count:
+            placed = {a.session_id: a for a in self.timetable.values()}
+            result['warm_start'] = {
+                'pinned': self.pinned_count,
+                'preferred': len(self.preferred_slots),
+                'preferred_kept': sum(
+                    1 for session_id, slot in self.preferred_slots.items()
+                    if session_id in placed and (placed[session_id].day, placed[session_id].period) == slot
+                )
+            }
+
+        return result
+
 # ==================== API ====================
 
-def schedule_timetable(data: Dict, strategy: str = "section",
-                       max_time_seconds: int = 300) -> Dict:
+STRATEGIES = ("section", "course", "day", "ga", "auto")
+
+def instance_features(data: Dict) -> Dict:
+    """
+    Selector features of an instance (BacktrackingScheduler._instance_features
+    over the course expansion). Computed on a scheduler of its own, so the
+    expansion does not stay compiled into the one that solves.
+    """
+    probe = BacktrackingScheduler(data)
+    return probe._instance_features(probe._get_all_sessions_to_schedule())
+
+def schedule_timetable(data: Dict, strategy: str = "section", max_time_seconds: int = 300,
+                       columnar: bool = False, preemption_slot: Optional[int] = None,
+                       trace_id: Optional[str] = None) -> Dict:
     """
     Entry point for scheduling
 
     Args:
-        data: Input data dictionary
-        strategy: "section" or "course"
+        data: Input data dictionary. Optional keys 'pinned_assignments' and
+              'preferred_assignments' take schedule entries in the output
+              format (e.g. a previous result['schedule'] to warm start from);
+              'precedence' takes ordering rules ({before, after, course_id,
+              min_gap_days, same_day}, see verifier.precedence_rules);
+              'workload_limits' caps periods per day and consecutive periods
+              and sets minimum days per week for sections and instructors
+              (see verifier.workload_limits); 'building_distances' and
+              'building_travel' forbid (hard) or penalize (soft, reported
+              in result['building_travel']) back-to-back sessions in
+              distant buildings (see verifier.building_travel)
+        strategy: "section", "course", "day", "ga" or "auto"
         max_time_seconds: Maximum solving time
+        columnar: Return result['schedule'] as a ScheduleColumns (cheap to
+                  send between processes) instead of a list of entries
+        preemption_slot: Flag index to poll (pool processes started with
+                         init_preemption_flags); a set flag ends the solve
+                         with status 'preempted'
+        trace_id: Request id to record tracing spans under (SCHEDULER_TRACE=1);
+                  the events are returned in result['trace_events']
     """
+    tracer = start_trace(trace_id)
     try:
         scheduler = BacktrackingScheduler(data)
-        result = scheduler.solve(strategy, max_time_seconds)
+        scheduler.preemption_slot = preemption_slot
+        result = scheduler.solve(strategy, max_time_seconds, columnar)
+        _verify_result(data, result, columnar)
+
+        if tracer is not None:
+            result['trace_events'] = tracer.events
         return result
     except Exception as e:
         import traceback
@@ -697,6 +3169,325 @@ def schedule_timetable(data: Dict, strategy: str = "section",
             'message': str(e),
             'traceback': traceback.format_exc()
         }
+    finally:
+        if tracer is not None:
+            stop_trace()
+
+def _verify_result(data: Dict, result: Dict, columnar: bool):
+    """Never hand out a schedule the independent checker rejects silently"""
+    if result['status'] not in ('success', 'partial'):
+        return
+    with span("verify"):
+        schedule = result['schedule']
+        report = verify_schedule(data, schedule.iter_entries() if columnar else schedule)
+        result['violations'] = [v['message'] for v in report['violations']]
+        if result['violations'] and result['status'] == 'success':
+            result['status'] = 'failed'
+            result['message'] = f"Schedule fails verification ({len(result['violations'])} violations)"
+
+def stream_timetable(data: Dict, progress, strategy: str = "section", max_time_seconds: int = 300,
+                     preemption_slot: Optional[int] = None, nodes_per_step: int = 4096,
+                     progress_interval: float = 0.5) -> Dict:
+    """
+    Solve for a streamed request (a job queue job in a pool process). The
+    cooperative search (iter_solve) puts its progress dicts on `progress`,
+    a queue shared with the API process, at most every progress_interval
+    seconds; strategies it cannot step (day, ga) run as schedule_timetable
+    and report only their result. The result is verified the same way and
+    its schedule is a ScheduleColumns; a set preemption flag ends the solve
+    with status 'preempted'.
+    """
+    selection = None
+    if strategy == "auto":
+        selection = select_strategy(instance_features(data))
+        strategy = selection['strategy']
+    if strategy not in ("section", "course"):
+        result = schedule_timetable(data, strategy, max_time_seconds, columnar=True, preemption_slot=preemption_slot)
+    else:
+        try:
+            result = _stream_search(data, progress, strategy, max_time_seconds, preemption_slot,
+                                    nodes_per_step, progress_interval)
+        except Exception as e:
+            import traceback
+            return {
+                'status': 'error',
+                'message': str(e),
+                'traceback': traceback.format_exc()
+            }
+    if selection is not None:
+        result['strategy_selection'] = selection
+    return result
+
+def _stream_search(data: Dict, progress, strategy: str, max_time_seconds: int, preemption_slot: Optional[int],
+                   nodes_per_step: int, progress_interval: float) -> Dict:
+    scheduler = BacktrackingScheduler(data)
+    steps = scheduler.iter_solve(strategy, nodes_per_step, columnar=True)
+    deadline = time.time() + max_time_seconds
+    last_progress = 0.0
+    try:
+        for event in steps:
+            if event['event'] == 'result':
+                result = event['result']
+                _verify_result(data, result, columnar=True)
+                return result
+            if preemption_slot is not None and _preemption_flags[preemption_slot]:
+                return {'status': 'preempted', 'message': 'Solve stopped to free its worker for a higher-priority job',
+                        'attempts': event['attempts']}
+            if time.time() > deadline:
+                return {'status': 'timeout', 'message': 'Time limit reached', 'attempts': event['attempts'],
+                        'strategy': strategy}
+            if time.time() - last_progress >= progress_interval:
+                last_progress = time.time()
+                progress.put(event)
+    finally:
+        steps.close()
+
+def _solve_day_worker(args: Tuple) -> Dict:
+    """
+    Process-pool entry for solve_by_day: place one day's sessions.
+    Chronological backtracking on a single day is heavy-tailed, so the
+    worker restarts with alternating session orders (section queue order,
+    then fewest qualified instructors first) and a doubling time budget.
+    """
+    data, day, session_ids, max_time_seconds = args
+    start_time = time.time()
+    deadline = start_time + max_time_seconds
+    wanted = set(session_ids)
+    budget = 0.5
+    attempts = backtracks = 0
+    placements = None
+
+    for restart in range(64):
+        scheduler = BacktrackingScheduler(data)
+        scheduler._get_strategy_sessions("day")
+        scheduler._apply_assignment_hints(session_ids)
+        for session_id in session_ids:
+            scheduler.compiled_sessions[session_id].days = [day]
+        scheduler._enable_room_pool()
+        # Minimum days per week are a whole-week matter: _assign_days gives sections
+        # theirs, instructors are checked once solve_by_day merges the days
+        if scheduler.section_limits is not None:
+            scheduler.section_limits = scheduler.section_limits[:2] + (0,)
+            scheduler.section_min_days = [0] * len(scheduler.sections)
+        if scheduler.instructor_limits is not None:
+            scheduler.instructor_limits = scheduler.instructor_limits[:2] + (0,)
+
+        if restart % 2 == 0:
+            ordered = session_ids
+        else:
+            ordered = sorted(session_ids, key=lambda s: (len(scheduler.compiled_sessions[s].instructors),
+                                                         len(scheduler.compiled_sessions[s].rooms)))
+
+        scheduler.deadline = min(time.time() + budget, deadline)
+        try:
+            success = scheduler.solve_by_course(0, ordered)
+        except SearchTimeout:
+            success = False
+        attempts += scheduler.attempts
+        backtracks += scheduler.backtracks
+
+        if success:
+            placements = [
+                {'session_id': a.session_id, 'day': a.day, 'period': a.period,
+                 'instructor_id': a.instructor_id, 'room_id': a.room_id}
+                for a in {id(a): a for a in scheduler.timetable.values()}.values()
+                if a.session_id in wanted
+            ]
+            break
+
+        if time.time() >= deadline:
+            break
+        if restart % 2 == 1:
+            budget *= 2
+
+    return {
+        'day': day,
+        'sessions': len(session_ids),
+        'placements': placements,
+        'attempts': attempts,
+        'backtracks': backtracks,
+        'solve_time': time.time() - start_time
+    }
+
+_ga_worker = None  # (scheduler, decode order), set in each pool process by _init_ga_worker
+
+def _init_ga_worker(data: Dict):
+    """Compile once per GA process; islands reuse the scheduler between epochs"""
+    global _ga_worker
+    scheduler = BacktrackingScheduler(data)
+    session_ids = scheduler._get_strategy_sessions("ga")
+    scheduler._apply_assignment_hints(session_ids)
+    _ga_worker = (scheduler, scheduler._ga_order(session_ids))
+
+def _ga_island_worker(args: Tuple) -> Dict:
+    """Process-pool entry for solve_by_ga: evolve one island for one epoch"""
+    island, population, seed, population_size, max_time_seconds = args
+    scheduler, order = _ga_worker
+    attempts = scheduler.attempts
+    result = scheduler._evolve_island(order, population, population_size, random.Random(seed), max_time_seconds)
+    result['island'] = island
+    result['attempts'] = scheduler.attempts - attempts
+    return result
+
+class WorkerExchange:
+    """
+    Lock-free channel between enumeration workers on the same instance.
+    Each worker owns a lane only it writes: up to `capacity` solution slot
+    vectors and one forbidden-start bitset per session (learned nogoods).
+    A lane's count is bumped after its vector is written, so readers never
+    see half a solution; readers poll and never wait.
+    """
+    def __init__(self, workers: int, n_sessions: int, capacity: int = 16):
+        import multiprocessing
+
+        self.workers = workers
+        self.n_sessions = n_sessions
+        self.capacity = capacity
+        self.counts = multiprocessing.RawArray('i', workers)
+        self.slots = multiprocessing.RawArray('h', workers * capacity * n_sessions)
+        self.nogoods = multiprocessing.RawArray('Q', workers * n_sessions)
+
+    def publish_solution(self, worker: int, slots: List[int]) -> bool:
+        count = self.counts[worker]
+        if count >= self.capacity or len(slots) != self.n_sessions:
+            return False
+        base = (worker * self.capacity + count) * self.n_sessions
+        self.slots[base:base + self.n_sessions] = slots
+        self.counts[worker] = count + 1
+        return True
+
+    def publish_nogood(self, worker: int, session_id: int, slot: int):
+        self.nogoods[worker * self.n_sessions + session_id] |= 1 << slot
+
+    def read_solutions(self, worker: int, seen: List[int]) -> List[List[int]]:
+        """Other workers' solutions not read yet; seen[w] counts what was read from lane w"""
+        new = []
+        for other in range(self.workers):
+            if other == worker:
+                continue
+            count = self.counts[other]
+            for i in range(seen[other], count):
+                base = (other * self.capacity + i) * self.n_sessions
+                new.append(self.slots[base:base + self.n_sessions])
+            seen[other] = count
+        return new
+
+    def read_nogoods(self) -> Dict[int, int]:
+        """session_id -> union of every lane's forbidden start slots"""
+        forbidden = {}
+        for other in range(self.workers):
+            base = other * self.n_sessions
+            for session_id, mask in enumerate(self.nogoods[base:base + self.n_sessions]):
+                if mask:
+                    forbidden[session_id] = forbidden.get(session_id, 0) | mask
+        return forbidden
+
+_worker_exchange = None  # Set in each pool process by _init_enumerate_worker
+
+def _init_enumerate_worker(exchange: WorkerExchange):
+    global _worker_exchange
+    _worker_exchange = exchange
+
+def _enumerate_worker(args: Tuple) -> Dict:
+    """Process-pool entry for schedule_alternatives"""
+    data, worker, k, min_distance, strategy, max_time_seconds = args
+    scheduler = BacktrackingScheduler(data)
+    scheduler.exchange = _worker_exchange
+    scheduler.worker = worker
+    result = scheduler.enumerate_solutions(k, min_distance, strategy, max_time_seconds, day_offset=worker)
+    result['worker'] = worker
+    return result
+
+def schedule_alternatives(data: Dict, k: int = 3, min_distance: int = 20, strategy: str = "section",
+                          max_time_seconds: int = 300, workers: Optional[int] = None) -> Dict:
+    """
+    Find k timetables pairwise at least min_distance sessions apart in
+    (session -> day/period) space. Each worker process runs its own
+    enumeration from a different value order; solutions are merged as
+    workers finish and the pool is stopped once k distinct ones are kept.
+    Workers also swap solutions and learned nogoods through a
+    WorkerExchange, so each steers clear of the others' timetables and
+    stops once k have been published between them.
+
+    Args:
+        data: Input data dictionary
+        k: Number of alternatives wanted
+        min_distance: Minimum number of sessions on a different day/period
+        strategy: "section" or "course"
+        max_time_seconds: Time limit per worker
+        workers: Worker processes (defaults to the CPU count, at most k)
+    """
+    import multiprocessing
+
+    workers = workers or min(k, multiprocessing.cpu_count())
+    start_time = time.time()
+
+    # Workers compile the same sessions, so slot vectors line up across lanes
+    probe = BacktrackingScheduler(data)
+    probe._get_strategy_sessions(strategy)
+
+    # Over budget: fewer workers, each held to its share of what is left
+    workers = probe.memory.workers_within_budget(workers)
+    worker_data = data
+    if probe.memory.budget is not None:
+        share = (probe.memory.budget - probe.memory.current) / workers
+        worker_data = dict(data, memory_budget_mb=max(share, probe.memory.current) / MB)
+    exchange = WorkerExchange(workers, len(probe.compiled_sessions), capacity=k)
+
+    accepted = []  # (slots, result)
+    per_worker = []
+    solutions_found = 0
+
+    with multiprocessing.Pool(workers, initializer=_init_enumerate_worker, initargs=(exchange,)) as pool:
+        jobs = [(worker_data, worker, k, min_distance, strategy, max_time_seconds) for worker in range(workers)]
+        for worker_result in pool.imap_unordered(_enumerate_worker, jobs):
+            solutions_found += len(worker_result['solutions'])
+            per_worker.append({
+                'worker': worker_result['worker'],
+                'solutions': len(worker_result['solutions']),
+                'attempts': worker_result['attempts'],
+                'search_time': worker_result['search_time'],
+                'attempts_per_second': worker_result['attempts'] / max(worker_result['search_time'], 1e-9),
+                'timed_out': worker_result['timed_out'],
+                'stopped_early': worker_result['stopped_early'],
+                'memory_exceeded': worker_result['memory_exceeded'],
+                'nogoods_learned': worker_result['nogoods_learned'],
+                'peak_memory_mb': worker_result['peak_memory_mb']
+            })
+
+            for slots, result in worker_result['solutions']:
+                if len(accepted) < k and all(
+                        sum(a != b for a, b in zip(slots, other)) >= min_distance for other, _ in accepted):
+                    accepted.append((slots, result))
+
+            if len(accepted) >= k:
+                pool.terminate()  # Remaining workers are still searching
+                break
+
+    wall_time = time.time() - start_time
+    alternatives = []
+    for _, result in accepted:
+        result['violations'] = [v['message'] for v in verify_schedule(data, result['schedule'])['violations']]
+        alternatives.append(result)
+
+    total_attempts = sum(w['attempts'] for w in per_worker)
+    return {
+        'status': 'success' if len(accepted) >= k else ('partial' if accepted else 'failed'),
+        'message': f"Found {len(accepted)} of {k} alternatives",
+        'solve_time': wall_time,
+        'min_distance': min_distance,
+        'distances': [[sum(a != b for a, b in zip(s1, s2)) for s2, _ in accepted] for s1, _ in accepted],
+        'alternatives': alternatives,
+        # Growth over the solve's start; upper bound: workers may not all have peaked at once
+        'peak_memory_mb': round(probe.memory.peak_growth_mb() + sum(w['peak_memory_mb'] for w in per_worker), 1),
+        'enumeration': {
+            'workers': workers,
+            'solutions_found': solutions_found,
+            'solutions_per_second': solutions_found / wall_time,
+            'attempts_per_second': total_attempts / wall_time,
+            'per_worker': sorted(per_worker, key=lambda w: w['worker'])
+        }
+    }
 
 # ==================== TESTING ====================
 
@@ -706,9 +3497,11 @@ if __name__ == "__main__":
     print("Choose strategy:")
     print("1. Section-by-section (like C++ code)")
     print("2. Course-by-course")
+    print("3. Day-then-period (one process per day)")
+    print("4. Island genetic algorithm (one process per island)")
 
-    choice = input("Enter choice (1 or 2): ").strip()
-    strategy = "section" if choice == "1" else "course"
+    choice = input("Enter choice (1, 2, 3 or 4): ").strip()
+    strategy = {"1": "section", "3": "day", "4": "ga"}.get(choice, "course")
 
     result = schedule_timetable(DATA, strategy=strategy, max_time_seconds=600)
 
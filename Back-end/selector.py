@@ -0,0 +1,163 @@
+"""
+Strategy selection from instance features
+Predicts the solve time of each strategy with a log-linear model over
+cheap instance features (computed by BacktrackingScheduler._instance_features)
+and picks the fastest. Used by strategy="auto".
+
+Usage:
+python selector.py collect results.jsonl [seeds] [time_limit]
+python selector.py fit results.jsonl [model.json]
+
+collect solves input.py and generated small and medium instances
+(differential.generate_instance, seeds 0..seeds-1) with every strategy and
+writes one record per run: 'instance_features', 'strategy' and
+'solve_time', where a run that does not succeed counts as taking the whole
+time limit. fit also accepts auto results, which carry the features. The
+fitted model is written to model.json (default strategy_model.json next to
+this file) and loaded automatically from there.
+"""
+
+from typing import List, Dict, Optional
+from collections import defaultdict
+import json
+import math
+import os
+import sys
+
+MODEL_PATH = os.path.join(os.path.dirname(os.path.abspath(__file__)), "strategy_model.json")
+
+# Model inputs, in weight order after the intercept
+MODEL_FEATURES = ["log_sessions", "max_room_tightness", "max_instructor_load", "conflict_density"]
+
+# log(seconds) = w0 + w . features. Fitted with `python selector.py collect`
+# (input.py and 16 generated instances, seeds 0-7, 30s limit, one core):
+# in sample it picks the fastest strategy on all 17 instances. Seventeen
+# instances, mostly small, are a thin basis; refit on real workloads.
+DEFAULT_MODEL = {
+    "section": [-21.041, 3.087, 2.756, 3.149, 3.798],
+    "course": [-21.803, 3.488, 2.454, 2.519, 5.291],
+    "day": [-6.41, -0.429, 3.193, 4.799, 3.88],
+    "ga": [-2.122, 0.877, 0.529, 0.345, -0.102]
+}
+
+# ==================== PREDICTION ====================
+
+def load_model(path: str = MODEL_PATH) -> Dict[str, List[float]]:
+    """Fitted model if one was saved, else the built-in calibration"""
+    if os.path.exists(path):
+        with open(path) as f:
+            return json.load(f)
+    return DEFAULT_MODEL
+
+def _feature_vector(features: Dict) -> List[float]:
+    return [1.0] + [float(features.get(name, 0.0)) for name in MODEL_FEATURES]
+
+def predict_solve_times(features: Dict, model: Optional[Dict] = None) -> Dict[str, float]:
+    """Predicted seconds per strategy"""
+    model = model or load_model()
+    x = _feature_vector(features)
+    return {
+        strategy: math.exp(min(sum(w * v for w, v in zip(weights, x)), 50.0))
+        for strategy, weights in model.items()
+    }
+
+def select_strategy(features: Dict, model: Optional[Dict] = None) -> Dict:
+    """Pick the strategy with the lowest predicted time"""
+    predicted = predict_solve_times(features, model)
+    chosen = min(predicted, key=predicted.get)
+    return {'strategy': chosen, 'predicted_seconds': predicted}
+
+# ==================== TRAINING ====================
+
+def _solve_linear(a: List[List[float]], b: List[float]) -> List[float]:
+    """Gaussian elimination with partial pivoting (a is small and square)"""
+    n = len(b)
+    m = [row[:] + [b[i]] for i, row in enumerate(a)]
+    for col in range(n):
+        pivot = max(range(col, n), key=lambda r: abs(m[r][col]))
+        m[col], m[pivot] = m[pivot], m[col]
+        if abs(m[col][col]) < 1e-12:
+            continue
+        for r in range(n):
+            if r != col:
+                factor = m[r][col] / m[col][col]
+                for c in range(col, n + 1):
+                    m[r][c] -= factor * m[col][c]
+    return [m[i][n] / m[i][i] if abs(m[i][i]) >= 1e-12 else 0.0 for i in range(n)]
+
+def fit_model(records: List[Dict], ridge: float = 1e-3) -> Dict[str, List[float]]:
+    """
+    Ridge least squares on log(solve_time) per strategy. Failed or timed
+    out runs keep their solve_time, which makes them a lower bound pulled
+    in as if exact; strategies without records keep the default weights.
+    """
+    samples = defaultdict(list)
+    for record in records:
+        if 'instance_features' not in record or record.get('solve_time') is None:
+            continue
+        samples[record['strategy']].append(
+            (_feature_vector(record['instance_features']), math.log(max(record['solve_time'], 1e-6))))
+
+    model = {strategy: list(weights) for strategy, weights in DEFAULT_MODEL.items()}
+    for strategy, rows in samples.items():
+        n = len(MODEL_FEATURES) + 1
+        xtx = [[ridge if i == j and i > 0 else 0.0 for j in range(n)] for i in range(n)]
+        xty = [0.0] * n
+        for x, y in rows:
+            for i in range(n):
+                xty[i] += x[i] * y
+                for j in range(n):
+                    xtx[i][j] += x[i] * x[j]
+        model[strategy] = _solve_linear(xtx, xty)
+    return model
+
+# ==================== DATA COLLECTION ====================
+
+def collect_records(seeds: int = 8, time_limit: float = 30.0) -> List[Dict]:
+    """Solve the benchmark instances with every strategy; one fit_model record per run"""
+    import contextlib
+    import io
+    from differential import generate_instance
+    from input import DATA
+    from scheduler import schedule_timetable, instance_features
+
+    instances = [("input.py", DATA)] + [(f"{size}-{seed}", generate_instance(seed, size))
+                                        for seed in range(seeds) for size in ("small", "medium")]
+    records = []
+    for name, data in instances:
+        features = instance_features(data)
+        for strategy in DEFAULT_MODEL:
+            with contextlib.redirect_stdout(io.StringIO()):
+                result = schedule_timetable(data, strategy, time_limit)
+            solve_time = result['solve_time'] if result['status'] == 'success' else time_limit
+            records.append({'instance': name, 'strategy': strategy, 'status': result['status'],
+                            'solve_time': solve_time, 'instance_features': features})
+            print(f"{name:>10} {strategy:>8}: {result['status']:>8} {solve_time:.2f}s")
+    return records
+
+# ==================== CLI ====================
+
+if __name__ == "__main__":
+    if len(sys.argv) < 3 or sys.argv[1] not in ("fit", "collect"):
+        print(__doc__)
+        sys.exit(2)
+
+    if sys.argv[1] == "collect":
+        seeds = int(sys.argv[3]) if len(sys.argv) > 3 else 8
+        time_limit = float(sys.argv[4]) if len(sys.argv) > 4 else 30.0
+        with open(sys.argv[2], 'w') as f:
+            for record in collect_records(seeds, time_limit):
+                f.write(json.dumps(record) + "\n")
+        sys.exit(0)
+
+    with open(sys.argv[2]) as f:
+        records = [json.loads(line) for line in f if line.strip()]
+    model = fit_model(records)
+
+    path = sys.argv[3] if len(sys.argv) > 3 else MODEL_PATH
+    with open(path, 'w') as f:
+        json.dump(model, f, indent=2)
+
+    print(f"Fitted on {len(records)} records -> {path}")
+    for strategy, weights in model.items():
+        print(f"  {strategy}: " + ", ".join(f"{w:.3f}" for w in weights))
@@ -0,0 +1,186 @@
+"""
+Import smoke test for the API service
+Runs against FastAPI when it is installed; otherwise against minimal
+stand-ins for fastapi, pydantic and pandas, so a module-level error (such
+as registering a middleware before its class exists) still fails here.
+
+Run:
+python -m pytest test_api_service.py
+"""
+
+import asyncio
+import importlib
+import json
+import queue
+import sys
+import types
+
+import pytest
+
+def _stub_modules():
+    """Just enough of fastapi, pydantic and pandas for api_service to import"""
+    class FastAPI:
+        def __init__(self, **kwargs):
+            self.user_middleware = []
+
+        def add_middleware(self, cls, **options):
+            self.user_middleware.insert(0, types.SimpleNamespace(cls=cls, options=options))
+
+        def _route(self, *args, **kwargs):
+            return lambda fn: fn
+
+        post = get = delete = on_event = exception_handler = _route
+
+    class HTTPException(Exception):
+        def __init__(self, status_code: int, detail=None):
+            super().__init__(detail)
+            self.status_code, self.detail = status_code, detail
+
+    fastapi = types.ModuleType("fastapi")
+    fastapi.FastAPI, fastapi.HTTPException = FastAPI, HTTPException
+    fastapi.File = lambda *args, **kwargs: None
+    fastapi.UploadFile = fastapi.Request = type("Placeholder", (), {})
+    class Response:
+        def __init__(self, content=None, **kwargs):
+            self.body_iterator = content
+
+    responses = types.ModuleType("fastapi.responses")
+    responses.JSONResponse = responses.FileResponse = responses.StreamingResponse = Response
+    middleware = types.ModuleType("fastapi.middleware")
+    cors = types.ModuleType("fastapi.middleware.cors")
+    cors.CORSMiddleware = type("CORSMiddleware", (), {})
+    pydantic = types.ModuleType("pydantic")
+    pydantic.BaseModel = type("BaseModel", (), {})
+    return {"fastapi": fastapi, "fastapi.responses": responses, "fastapi.middleware": middleware,
+            "fastapi.middleware.cors": cors, "pydantic": pydantic, "pandas": types.ModuleType("pandas")}
+
+def import_api_service():
+    for name, module in _stub_modules().items():
+        try:
+            importlib.import_module(name)
+        except ImportError:
+            sys.modules[name] = module
+    return importlib.import_module("api_service")
+
+def test_import_registers_middlewares():
+    api_service = import_api_service()
+    registered = [m.cls for m in api_service.app.user_middleware]
+    assert api_service.TraceMiddleware in registered
+    assert any(cls.__name__ == "CORSMiddleware" for cls in registered)
+
+def test_trace_middleware_passes_untraced_requests_through():
+    api_service = import_api_service()
+    seen = []
+
+    async def app(scope, receive, send):
+        seen.append(scope['path'])
+        await send({'type': 'http.response.start', 'status': 200, 'headers': []})
+
+    sent = []
+
+    async def send(message):
+        sent.append(message)
+
+    async def receive():
+        return {'type': 'http.request', 'body': b''}
+
+    scope = {'type': 'http', 'path': '/api/health', 'method': 'GET', 'headers': []}
+    asyncio.run(api_service.TraceMiddleware(app)(scope, receive, send))
+    assert seen == ['/api/health']
+    assert sent[0]['headers'] == []  # No X-Request-Id outside the traced paths
+
+def test_client_request_ids_cannot_escape_the_trace_directory(monkeypatch, tmp_path):
+    api_service = import_api_service()
+    import tracing
+    write = tracing.Tracer.write
+    monkeypatch.setattr(api_service, "TRACE_ENABLED", True)
+    monkeypatch.setattr(tracing, "TRACE_ENABLED", True)
+    monkeypatch.setattr(tracing.Tracer, "write", lambda self, directory=str(tmp_path): write(self, directory))
+
+    async def app(scope, receive, send):
+        await send({'type': 'http.response.start', 'status': 200, 'headers': []})
+        await send({'type': 'http.response.body', 'body': b''})
+
+    async def receive():
+        return {'type': 'http.request', 'body': b''}
+
+    for header, kept in ((b"run-42_a", True), (b"../../x", False), (b"/tmp/x", False), (b"a" * 65, False)):
+        sent = []
+
+        async def send(message):
+            sent.append(message)
+
+        scope = {'type': 'http', 'path': '/api/schedule', 'method': 'POST', 'headers': [(b'x-request-id', header)]}
+        asyncio.run(api_service.TraceMiddleware(app)(scope, receive, send))
+        request_id = dict(sent[0]['headers'])[b'x-request-id'].decode()
+        assert (request_id == header.decode()) == kept
+        assert (tmp_path / f"{request_id}.json").exists()
+    assert len(list(tmp_path.iterdir())) == 4
+
+def test_requested_strategy_reaches_the_estimate_and_the_solve(monkeypatch):
+    api_service = import_api_service()
+    calls = {}
+
+    def estimate(data, strategy, max_time_seconds):
+        calls['estimate'] = strategy
+        return 1.0
+
+    async def submit(priority, client_id, estimated, fn, *args, **kwargs):
+        calls['solve'] = kwargs['strategy']
+        return {'status': 'failed', 'message': 'No solution found', 'schedule': None}
+
+    monkeypatch.setattr(api_service, "estimate_solve_seconds", estimate)
+    monkeypatch.setattr(api_service.job_queue, "submit", submit)
+    asyncio.run(api_service.run_schedule({}, 10, strategy="auto"))
+    assert calls == {'estimate': "auto", 'solve': "auto"}
+
+    api_service.check_strategy("auto")
+    try:
+        api_service.check_strategy("fastest")
+        assert False, "unknown strategy accepted"
+    except api_service.HTTPException as e:
+        assert e.status_code == 400
+
+def test_stream_runs_through_the_job_queue_and_sends_a_verified_result(monkeypatch, small_data):
+    api_service = import_api_service()
+    submitted = {}
+
+    async def submit(priority, client_id, estimated, fn, *args, preemptible=False, **kwargs):
+        submitted.update(fn=fn, strategy=kwargs['strategy'], preemptible=preemptible)
+        return await asyncio.to_thread(fn, *args, **kwargs)
+
+    monkeypatch.setattr(api_service, "estimate_solve_seconds", lambda *args: 1.0)
+    monkeypatch.setattr(api_service, "progress_queue", queue.Queue)
+    monkeypatch.setattr(api_service.job_queue, "submit", submit)
+    http_request = types.SimpleNamespace(client=None, headers={})
+
+    async def stream(strategy):
+        request = types.SimpleNamespace(data=small_data, strategy=strategy, max_time_seconds=30, columnar=False)
+        response = await api_service.stream_schedule(request, http_request)
+        return [json.loads(line) async for line in response.body_iterator]
+
+    for strategy in ("course", "day"):
+        events = asyncio.run(stream(strategy))
+        assert submitted == {'fn': api_service.stream_timetable, 'strategy': strategy, 'preemptible': True}
+        assert events[-1]['event'] == 'result' and all(e['event'] == 'progress' for e in events[:-1])
+        result = events[-1]['result']
+        assert result['status'] == 'success' and result['violations'] == []
+        assert {row['section_id'] for row in result['schedule']} == {s['section_id'] for s in small_data['sections']}
+
+def test_stream_is_admitted_like_a_solve(monkeypatch, small_data):
+    api_service = import_api_service()
+
+    def admit(priority, estimated_seconds, processes=1):
+        raise api_service.AdmissionError("solve queue is full")
+
+    monkeypatch.setattr(api_service, "estimate_solve_seconds", lambda *args: 1.0)
+    monkeypatch.setattr(api_service.job_queue, "admit", admit)
+    request = types.SimpleNamespace(data=small_data, strategy="section", max_time_seconds=30, columnar=False)
+    with pytest.raises(api_service.HTTPException) as refused:
+        asyncio.run(api_service.stream_schedule(request, types.SimpleNamespace(client=None, headers={})))
+    assert refused.value.status_code == 429
+
+if __name__ == "__main__":
+    test_import_registers_middlewares()
+    test_trace_middleware_passes_untraced_requests_through()
+    print("api_service imports and registers its middlewares")
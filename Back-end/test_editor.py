@@ -0,0 +1,75 @@
+"""
+Behavior tests for interactive timetable editing
+Moves on the solved small_data timetable (conftest.py): conflicts and rule
+problems are reported, valid moves keep the timetable valid, and the
+editor store drops idle and least recently used editors.
+
+Run:
+python -m pytest test_editor.py
+"""
+
+import copy
+import time
+
+import pytest
+
+from editor import TimetableEditor, EditorStore
+from verifier import verify_schedule, DAY_NAMES
+
+def free_moves(editor, row):
+    """Every (day, start_period) the editor accepts for this row's session"""
+    return [(day, period) for day in DAY_NAMES for period in range(1, 9)
+            if editor.check_move(row['instance_id'], day, period)['valid']]
+
+def test_valid_moves_keep_the_timetable_valid(solved):
+    data, schedule = solved
+    editor = TimetableEditor(data, schedule)
+    for row in editor.get_schedule():
+        moves = free_moves(editor, row)
+        if moves:
+            result = editor.apply_move(row['instance_id'], *moves[-1])
+            assert result['applied']
+            assert verify_schedule(data, editor.get_schedule())['valid']
+
+def test_move_onto_a_busy_section_conflicts(solved):
+    editor = TimetableEditor(*solved)
+    schedule = editor.get_schedule()
+    row = next(r for r in schedule if (r['course_id'], r['type']) == ("C101", "Tut"))
+    other = next(r for r in schedule if r['section_id'] == row['section_id'] and r['course_id'] == "C102")
+    result = editor.check_move(row['instance_id'], other['day'], other['start_period'])
+    assert not result['valid'] and result['conflicts']
+    assert editor.apply_move(row['instance_id'], other['day'], other['start_period'])['applied'] is False
+
+def test_unknown_days(solved):
+    data, schedule = solved
+    editor = TimetableEditor(data, schedule)
+    row = editor.get_schedule()[0]
+    for day in ("Friday", 9, -1):
+        result = editor.check_move(row['instance_id'], day, 1)
+        assert not result['valid'] and any("Unknown day" in v for v in result['violations'])
+
+    with pytest.raises(ValueError):
+        TimetableEditor(data, [dict(schedule[0], day="Saturday")] + schedule[1:])
+
+def test_store_evicts_idle_and_least_recently_used_editors(solved):
+    editor = TimetableEditor(*solved)
+    store = EditorStore(ttl_seconds=60, max_sessions=2)
+    first, second = store.add(editor), store.add(copy.copy(editor))
+    assert store.get(first) is editor  # first is now the most recently used
+    third = store.add(copy.copy(editor))
+    assert store.get(second) is None and store.get(first) is not None and store.get(third) is not None
+    assert store.remove(first) and not store.remove(first)
+
+    idle = EditorStore(ttl_seconds=0.05)
+    edit_session_id = idle.add(editor)
+    time.sleep(0.1)
+    assert idle.get(edit_session_id) is None and len(idle) == 0
+
+def test_rule_problems_block_moves(small_data, solve):
+    small_data['courses'] = [c for c in small_data['courses'] if not c.get('is_project')]
+    small_data['workload_limits'] = {'sections': {'max_periods_per_day': 4}}
+    editor = TimetableEditor(small_data, solve(small_data)['schedule'])
+    checked = [editor.check_move(row['instance_id'], day, period)
+               for row in editor.get_schedule() for day in DAY_NAMES for period in (1, 3, 5, 7)]
+    blocked = [result for result in checked if result['violations'] and not result['conflicts']]
+    assert blocked and not any(result['valid'] for result in blocked)
@@ -0,0 +1,119 @@
+"""
+Behavior tests for solve job admission and preemption
+Jobs run in a thread pool with a plain list as the preemption flags, so
+a job sees its flag the moment the queue sets it.
+
+Run:
+python -m pytest test_job_queue.py
+"""
+
+import asyncio
+import time
+from concurrent.futures import ThreadPoolExecutor
+
+import pytest
+
+from job_queue import SolveJobQueue, AdmissionError, PRIORITY_INTERACTIVE, PRIORITY_SOLVE, PRIORITY_BATCH
+
+FLAGS = [0, 0]
+STARTED = []
+
+def job(name: str, seconds: float = 0.05, preemption_slot=None) -> dict:
+    """Runs for `seconds`, polling its flag like a solve polls at checkpoints"""
+    STARTED.append(name)
+    deadline = time.time() + seconds
+    while time.time() < deadline:
+        if preemption_slot is not None and FLAGS[preemption_slot]:
+            return {'status': 'preempted'}
+        time.sleep(0.005)
+    return {'status': 'success', 'name': name}
+
+def make_queue(workers: int = 1, **kwargs) -> SolveJobQueue:
+    FLAGS[:] = [0] * workers
+    STARTED.clear()
+    return SolveJobQueue(ThreadPoolExecutor(workers), FLAGS, workers, **kwargs)
+
+def test_admission_refuses_jobs_over_the_class_budget():
+    async def run():
+        queue = make_queue(queue_budgets={PRIORITY_SOLVE: 10.0})
+        running = asyncio.ensure_future(queue.submit(PRIORITY_SOLVE, "a", 1.0, job, "running", 0.2))
+        await asyncio.sleep(0.01)
+        queued = asyncio.ensure_future(queue.submit(PRIORITY_SOLVE, "b", 8.0, job, "queued"))
+        await asyncio.sleep(0.01)
+        with pytest.raises(AdmissionError):
+            await queue.submit(PRIORITY_SOLVE, "c", 5.0, job, "refused")
+        return await running, await queued
+    running, queued = asyncio.run(run())
+    assert running['name'] == "running" and queued['name'] == "queued"
+
+def test_admission_counts_running_jobs_and_fan_out():
+    async def run():
+        queue = make_queue(queue_budgets={PRIORITY_SOLVE: 10.0})
+        running = asyncio.ensure_future(queue.submit(PRIORITY_SOLVE, "a", 8.0, job, "running", 0.2))
+        await asyncio.sleep(0.01)
+        assert not queue.pending
+        with pytest.raises(AdmissionError):
+            await queue.submit(PRIORITY_SOLVE, "b", 5.0, job, "refused")
+        await running
+        # Three processes of 4s each do not fit a 10s budget even on an idle queue
+        with pytest.raises(AdmissionError):
+            await queue.submit(PRIORITY_SOLVE, "c", 4.0, job, "fan-out", processes=3)
+        return await queue.submit(PRIORITY_SOLVE, "c", 4.0, job, "fan-out", processes=2)
+    assert asyncio.run(run())['name'] == "fan-out"
+    assert "refused" not in STARTED
+
+def test_cancelled_jobs_leave_the_queue():
+    async def run():
+        queue = make_queue(queue_budgets={PRIORITY_SOLVE: 10.0})
+        running = asyncio.ensure_future(queue.submit(PRIORITY_SOLVE, "a", 1.0, job, "running", 0.1))
+        await asyncio.sleep(0.01)
+        queued = asyncio.ensure_future(queue.submit(PRIORITY_SOLVE, "b", 8.0, job, "cancelled"))
+        await asyncio.sleep(0.01)
+        queued.cancel()
+        await asyncio.sleep(0.01)
+        assert not queue.pending and queue.stats()['queued_seconds']['solve'] == 0
+        # The cancelled job's budget is free again
+        admitted = await queue.submit(PRIORITY_SOLVE, "c", 8.0, job, "admitted")
+        await running
+        return admitted
+    assert asyncio.run(run())['name'] == "admitted"
+    assert STARTED == ["running", "admitted"]
+
+def test_cancelled_running_job_is_stopped():
+    async def run():
+        queue = make_queue()
+        long = asyncio.ensure_future(queue.submit(PRIORITY_SOLVE, "a", 1.0, job, "long", 5.0, preemptible=True))
+        await asyncio.sleep(0.02)
+        long.cancel()
+        start = time.time()
+        result = await queue.submit(PRIORITY_SOLVE, "b", 1.0, job, "next", 0.01)
+        return result, time.time() - start, queue.stats()
+    result, waited, stats = asyncio.run(run())
+    assert result['name'] == "next" and waited < 1.0
+    assert stats['preempted'] == 0 and stats['completed'] == 1
+
+def test_client_cap_lets_other_clients_go_first():
+    async def run():
+        queue = make_queue(workers=2, client_cap=1)
+        finished = []
+
+        async def submit(client, name, seconds):
+            result = await queue.submit(PRIORITY_SOLVE, client, 1.0, job, name, seconds)
+            finished.append(result['name'])
+
+        await asyncio.gather(submit("a", "a1", 0.2), submit("a", "a2", 0.05), submit("b", "b1", 0.05))
+        return finished
+    # a2 waits for a1 although a worker is free; b1 takes it
+    assert asyncio.run(run()) == ["b1", "a1", "a2"]
+
+def test_higher_priority_preempts_and_the_victim_is_requeued():
+    async def run():
+        queue = make_queue()
+        batch = asyncio.ensure_future(queue.submit(PRIORITY_BATCH, "a", 1.0, job, "batch", 0.3, preemptible=True))
+        await asyncio.sleep(0.02)
+        interactive = await queue.submit(PRIORITY_INTERACTIVE, "b", 1.0, job, "interactive", 0.02)
+        return interactive, await batch, queue.stats()
+    interactive, batch, stats = asyncio.run(run())
+    assert interactive['name'] == "interactive" and interactive['job']['preemptions'] == 0
+    assert batch['name'] == "batch" and batch['job']['preemptions'] == 1
+    assert stats['preempted'] == 1 and stats['completed'] == 2
@@ -0,0 +1,177 @@
+"""
+Behavior tests for the scheduler
+Run on the small_data fixture (conftest.py): a lab shared by sections, a
+tutorial and a graduation project, solved by every strategy; pins,
+preferences, lab grouping, anchors and the precedence, workload and travel
+constraints are checked on the solved timetables.
+
+Run:
+python -m pytest test_scheduler.py
+"""
+
+import copy
+import queue
+
+import pytest
+
+import scheduler as scheduler_module
+from scheduler import BacktrackingScheduler, schedule_timetable, schedule_alternatives, stream_timetable
+from verifier import verify_schedule, DAY_NAMES
+
+def sessions(schedule, course_id, session_type):
+    """Sorted section ids of each placed session of this course and type"""
+    placed = {}
+    for row in schedule:
+        if row['course_id'] == course_id and row['type'] == session_type:
+            placed.setdefault((row['day'], row['start_period'], row['room_id']), []).append(row['section_id'])
+    return sorted(sorted(s) for s in placed.values())
+
+def test_section_queues_own_each_session_once(small_data, solve):
+    scheduler = BacktrackingScheduler(small_data)
+    queued = [session_id for queue in scheduler.section_queues for session_id in queue]
+    assert len(queued) == len(set(queued))
+    for idx, queue in enumerate(scheduler.section_queues):
+        # A section attends every session it owns
+        assert all(scheduler.section_required_masks[idx] >> session_id & 1 for session_id in queue)
+    required = {(r['course_id'], r['type'], r['section_id']) for r in solve(small_data)['schedule']}
+    assert {(s.course.course_id, s.kind.type, sid) for s in scheduler.compiled_sessions
+            if not s.course.is_project for sid in s.sections} <= required
+
+def test_pinned_timetable_is_kept(small_data, solve):
+    schedule = solve(small_data)['schedule']
+    small_data['pinned_assignments'] = schedule
+    result = solve(small_data)
+    placed = {(r['course_id'], r['type'], r['section_id']): (r['day'], r['start_period']) for r in schedule}
+    assert {(r['course_id'], r['type'], r['section_id']): (r['day'], r['start_period'])
+            for r in result['schedule']} == placed
+
+def test_conflicting_pins_are_reported(small_data, solve):
+    schedule = solve(small_data)['schedule']
+    lecture = next(r for r in schedule if (r['course_id'], r['type']) == ("C101", "Lecture"))
+    tut = copy.deepcopy(next(r for r in schedule if (r['course_id'], r['type'], r['section_id']) ==
+                             ("C101", "Tut", lecture['section_id'])))
+    tut.update(day=lecture['day'], start_period=lecture['start_period'])
+    small_data['pinned_assignments'] = [lecture, tut]
+    result = schedule_timetable(small_data, strategy="section", max_time_seconds=30)
+    assert result['status'] == 'failed' and result['pin_conflicts']
+
+def test_pins_outside_the_week_are_reported(small_data, solve):
+    row = solve(small_data)['schedule'][0]
+    for day in (5, -1, "Friday"):
+        small_data['pinned_assignments'] = [dict(row, day=day)]
+        result = schedule_timetable(small_data, strategy="section", max_time_seconds=30)
+        assert result['status'] == 'failed'
+        assert result['pin_conflicts'] == [f"Pinned {row['course_id']} ({row['type']}) for {row['section_id']} "
+                                           f"has unknown day {day!r}"]
+
+def test_labs_respect_max_sections_together(small_data, solve):
+    labs = sessions(solve(small_data)['schedule'], "C101", "Lab")
+    assert sorted(s for lab in labs for s in lab) == ["Y1-G1-S1", "Y1-G1-S2", "Y1-G1-S3"]
+    assert all(len(lab) <= 2 for lab in labs)
+
+def test_preferred_timetable_is_kept_and_lab_partition_followed(small_data, solve):
+    schedule = solve(small_data)['schedule']
+    # Re-partition the lab as S1+S3 and S2 in the preferred timetable
+    labs = [r for r in schedule if (r['course_id'], r['type']) == ("C101", "Lab")]
+    slots = sorted({(r['day'], r['start_period']) for r in labs})
+    small_data['preferred_assignments'] = [r for r in schedule if r not in labs] + [
+        dict(r, day=slots[0][0], start_period=slots[0][1]) if r['section_id'] != "Y1-G1-S2"
+        else dict(r, day=slots[-1][0], start_period=slots[-1][1]) for r in labs]
+    scheduler = BacktrackingScheduler(small_data)
+    assert sorted(map(sorted, scheduler.hinted_lab_groups["C101"])) == [["Y1-G1-S1", "Y1-G1-S3"], ["Y1-G1-S2"]]
+
+    small_data['preferred_assignments'] = schedule
+    result = solve(small_data)
+    assert result['warm_start']['preferred_kept'] == result['warm_start']['preferred']
+
+@pytest.mark.parametrize("strategy", ["section", "course", "day", "ga", "auto"])
+def test_every_strategy_places_every_required_session(small_data, solve, strategy):
+    result = solve(small_data, strategy)
+    # The verifier reports required sessions that are missing; check the count too:
+    # C101 (3 types) and C102 (2) per first-year section, C201 (2) and the project per second-year one
+    assert len(result['schedule']) == 3 * 3 + 3 * 2 + 2 * 2 + 2
+
+def test_verifier_failure_is_not_success(small_data):
+    small_data['workload_limits'] = {'instructors': {'min_days_per_week': 5}}
+    result = schedule_timetable(small_data, strategy="day", max_time_seconds=30)
+    assert result['status'] != 'success'
+
+@pytest.mark.parametrize("strategy", ["section", "day"])
+def test_graduation_project_takes_a_whole_day(small_data, solve, strategy):
+    schedule = solve(small_data, strategy)['schedule']
+    project = [row for row in schedule if row['course_id'] == "PRJ2"]
+    assert sorted(row['section_id'] for row in project) == ["Y2-G1-S1", "Y2-G1-S2"]
+    others = [row for row in schedule if row['section_id'].startswith("Y2") and row['course_id'] != "PRJ2"]
+    assert all(row['day'] != project[0]['day'] for row in others)
+
+@pytest.mark.parametrize("strategy", ["section", "course"])
+@pytest.mark.parametrize("k", [1, 3])
+def test_enumeration_stops_at_k_solutions_apart(small_data, strategy, k):
+    scheduler = BacktrackingScheduler(small_data)
+    solutions = [slots for slots, _ in scheduler.enumerate_solutions(k, 3, strategy, max_time_seconds=30)['solutions']]
+    assert 1 <= len(solutions) <= k
+    assert all(sum(a != b for a, b in zip(s1, s2)) >= 3 for i, s1 in enumerate(solutions) for s2 in solutions[:i])
+    assert scheduler.placed_sessions == 0 and not scheduler.timetable  # Unwound after the search
+
+def test_alternatives_are_apart(small_data):
+    result = schedule_alternatives(small_data, k=3, min_distance=3, max_time_seconds=30, workers=2)
+    assert result['status'] == 'success' and len(result['alternatives']) == 3
+    assert all(d >= 3 for i, row in enumerate(result['distances']) for j, d in enumerate(row) if i != j)
+    assert all(alternative['violations'] == [] for alternative in result['alternatives'])
+
+@pytest.mark.parametrize("strategy", ["section", "day", "ga", "auto"])
+def test_missing_lab_rooms_fail_cleanly(small_data, strategy):
+    small_data['rooms'] = [r for r in small_data['rooms'] if r['type'] != "computer lab"]
+    result = schedule_timetable(small_data, strategy=strategy, max_time_seconds=10)
+    assert result['status'] == 'failed'
+
+def test_auto_alone_computes_features(small_data):
+    direct = BacktrackingScheduler(copy.deepcopy(small_data))
+    result = direct.solve("section", 30)
+    assert 'instance_features' not in result and 'strategy_selection' not in result
+
+    auto = BacktrackingScheduler(small_data)
+    result = auto.solve("auto", 30)
+    assert result['strategy_selection']['strategy'] == result['strategy'] and result['instance_features']
+    # Features come from a probe: the solving scheduler compiles only its own strategy's sessions
+    chosen = BacktrackingScheduler(copy.deepcopy(small_data))
+    chosen.solve(result['strategy'], 30)
+    assert len(auto.compiled_sessions) == len(chosen.compiled_sessions)
+
+def test_streamed_solve_reports_progress_and_is_verified(small_data, monkeypatch):
+    progress = queue.Queue()
+    result = stream_timetable(small_data, progress, "section", 30, nodes_per_step=1, progress_interval=0)
+    assert result['status'] == 'success' and result['violations'] == []
+    assert len(result['schedule'].to_rows(small_data)) == 3 * 3 + 3 * 2 + 2 * 2 + 2
+    assert not progress.empty() and progress.get()['event'] == 'progress'
+
+    monkeypatch.setattr(scheduler_module, "verify_schedule",
+                        lambda data, schedule: {'violations': [{'type': 'workload', 'message': "Too long"}]})
+    result = stream_timetable(small_data, queue.Queue(), "section", 30)
+    assert result['status'] == 'failed' and result['violations'] == ["Too long"]
+
+@pytest.mark.parametrize("strategy", ["section", "day"])
+def test_precedence_is_honored(small_data, solve, strategy):
+    small_data['precedence'] = [{'before': 'Lecture', 'after': 'Tut', 'min_gap_days': 1}]
+    schedule = solve(small_data, strategy)['schedule']
+    day = {(r['course_id'], r['type'], r['section_id']): DAY_NAMES.index(r['day']) for r in schedule}
+    for (course_id, session_type, section_id), tut_day in day.items():
+        if session_type == "Tut":
+            assert tut_day >= day[(course_id, "Lecture", section_id)] + 1
+
+@pytest.mark.parametrize("strategy", ["section", "course", "day"])
+def test_workload_limits_are_honored(small_data, solve, strategy):
+    small_data['courses'] = [c for c in small_data['courses'] if not c.get('is_project')]  # A project fills its day
+    small_data['workload_limits'] = {'sections': {'max_periods_per_day': 3, 'min_days_per_week': 3},
+                                     'instructors': {'max_consecutive_periods': 4, 'min_days_per_week': 2}}
+    days = {}
+    for row in solve(small_data, strategy)['schedule']:
+        days.setdefault(row['section_id'], set()).add(row['day'])
+    # Second-year sections only have two sessions
+    assert all(len(d) >= (3 if section_id.startswith("Y1") else 2) for section_id, d in days.items())
+
+def test_hard_travel_is_honored(small_data, solve):
+    small_data['building_distances'] = {"B1": {"B2": 5}}
+    small_data['building_travel'] = {'mode': "hard", 'max_distance': 0}
+    result = solve(small_data)
+    assert verify_schedule(small_data, result['schedule'])['counts'].get('building_travel', 0) == 0
@@ -0,0 +1,73 @@
+"""
+Behavior tests for the hard-constraint verifier
+Each test starts from the solved small_data timetable (conftest.py) and
+breaks one rule.
+
+Run:
+python -m pytest test_verifier.py
+"""
+
+import copy
+
+from verifier import verify_schedule
+
+def violation_types(data, schedule):
+    return {v['type'] for v in verify_schedule(data, schedule)['violations']}
+
+def test_solved_schedule_is_valid(solved):
+    data, schedule = solved
+    report = verify_schedule(data, schedule)
+    assert report['valid'], report['violations'][:3]
+    assert report['entries'] == len(schedule)
+
+def test_double_booked_section(solved):
+    data, schedule = solved
+    schedule = copy.deepcopy(schedule)
+    section_id = schedule[0]['section_id']
+    first, second = [row for row in schedule if row['section_id'] == section_id][:2]
+    for row in schedule:
+        if (row['course_id'], row['type'], row['start_period'], row['day']) == \
+                (second['course_id'], second['type'], second['start_period'], second['day']):
+            row.update(day=first['day'], start_period=first['start_period'])
+    assert 'section_overlap' in violation_types(data, schedule)
+
+def test_unknown_days_are_alignment_violations(solved):
+    data, schedule = solved
+    for day in (7, -1, "Friday"):
+        broken = copy.deepcopy(schedule)
+        broken[0]['day'] = day
+        assert 'alignment' in violation_types(data, broken)
+
+def test_missing_session(solved):
+    data, schedule = solved
+    dropped = schedule[0]
+    kept = [row for row in schedule if (row['course_id'], row['type']) != (dropped['course_id'], dropped['type'])]
+    report = verify_schedule(data, kept)
+    missing = [v['message'] for v in report['violations'] if v['type'] == 'missing_session']
+    assert missing and missing[0].startswith(f"{dropped['course_id']} ({dropped['type']})")
+
+def test_precedence(solved):
+    data, schedule = solved
+    # Five days' gap after the tutorial cannot fit in a five-day week
+    data['precedence'] = [{'before': 'Tut', 'after': 'Lecture', 'course_id': "C101", 'min_gap_days': 5}]
+    assert 'precedence' in violation_types(data, schedule)
+
+def test_workload(solved):
+    data, schedule = solved
+    data['workload_limits'] = {'sections': {'max_periods_per_day': 1}}
+    assert 'workload' in violation_types(data, schedule)
+    data['workload_limits'] = {'instructors': {'min_days_per_week': 5}}
+    assert 'workload' in violation_types(data, schedule)
+
+def test_travel(solved):
+    data, schedule = solved
+    # Every building pair far apart: any back-to-back sessions in two buildings break the hard limit
+    buildings = sorted({r['building'] for r in data['rooms']})
+    data['building_distances'] = {a: {b: 10 for b in buildings if b != a} for a in buildings}
+    data['building_travel'] = {'mode': "hard", 'max_distance': 0}
+    hard = verify_schedule(data, schedule)
+    data['building_travel'] = {'mode': "soft"}
+    soft = verify_schedule(data, schedule)
+    assert soft['valid']
+    hard_travel = [v for v in hard['violations'] if v['type'] == 'building_travel']
+    assert hard_travel and soft['travel_penalty'] == 10 * len(hard_travel)
@@ -0,0 +1,116 @@
+"""
+Scoped tracing spans in Chrome trace-event format
+Spans cover the pipeline stages of one request (parse, index build,
+session compilation, search phases, extraction, serialization, HTTP
+write) and are written per request id as traces/<request_id>.json, which
+chrome://tracing and Perfetto open directly.
+
+Enabled with SCHEDULER_TRACE=1, read once at import. When disabled,
+span() is bound to a function returning one shared no-op context
+manager, so instrumented code pays a call and nothing else; spans only
+wrap whole phases, never per-node search work.
+
+Worker processes record into their own Tracer and return the events in
+the result ('trace_events'); timestamps are wall-clock microseconds, so
+events from every process line up on one timeline.
+"""
+
+from typing import List, Dict, Optional
+from contextlib import contextmanager, nullcontext
+from contextvars import ContextVar
+import json
+import os
+import re
+import threading
+import time
+import uuid
+
+TRACE_ENABLED = os.environ.get("SCHEDULER_TRACE", "0") == "1"
+TRACE_DIR = os.environ.get("SCHEDULER_TRACE_DIR", os.path.join(os.path.dirname(os.path.abspath(__file__)), "traces"))
+
+# Tracer of the request being handled (per asyncio task / thread)
+_current_tracer: ContextVar[Optional["Tracer"]] = ContextVar("current_tracer", default=None)
+
+_NO_SPAN = nullcontext()
+
+# Request ids name trace files; anything else (paths, separators) is replaced
+REQUEST_ID_PATTERN = re.compile(r"[A-Za-z0-9_-]{1,64}")
+
+# ==================== TRACER ====================
+
+class Tracer:
+    def __init__(self, request_id: str):
+        self.request_id = request_id
+        self.events = []  # Chrome 'X' (complete) events
+
+    def add(self, name: str, start_us: int, end_us: int, args: Optional[Dict] = None):
+        event = {
+            'name': name,
+            'cat': 'scheduler',
+            'ph': 'X',
+            'ts': start_us,
+            'dur': end_us - start_us,
+            'pid': os.getpid(),
+            'tid': threading.get_native_id()
+        }
+        if args:
+            event['args'] = args
+        self.events.append(event)
+
+    def extend(self, events: List[Dict]):
+        """Merge events recorded by another process"""
+        self.events.extend(events)
+
+    def to_chrome(self) -> Dict:
+        return {
+            'traceEvents': sorted(self.events, key=lambda e: e['ts']),
+            'displayTimeUnit': 'ms',
+            'otherData': {'request_id': self.request_id}
+        }
+
+    def write(self, directory: str = TRACE_DIR) -> str:
+        os.makedirs(directory, exist_ok=True)
+        path = os.path.join(directory, f"{self.request_id}.json")
+        with open(path, 'w') as f:
+            json.dump(self.to_chrome(), f)
+        return path
+
+# ==================== SPANS ====================
+
+@contextmanager
+def _span(name: str, **args):
+    tracer = _current_tracer.get()
+    if tracer is None:
+        yield
+        return
+    start = time.time_ns() // 1000
+    try:
+        yield
+    finally:
+        tracer.add(name, start, time.time_ns() // 1000, args)
+
+def _no_span(name: str, **args):
+    return _NO_SPAN
+
+span = _span if TRACE_ENABLED else _no_span
+
+def clean_request_id(request_id: Optional[str]) -> str:
+    """The id if it is safe to use as a file name, otherwise a fresh one"""
+    if request_id and REQUEST_ID_PATTERN.fullmatch(request_id):
+        return request_id
+    return uuid.uuid4().hex
+
+def start_trace(request_id: Optional[str]) -> Optional[Tracer]:
+    """Make a new tracer current for this task/thread (None when tracing is off or no id)"""
+    if not TRACE_ENABLED or not request_id:
+        return None
+    tracer = Tracer(clean_request_id(request_id))
+    _current_tracer.set(tracer)
+    return tracer
+
+def current_tracer() -> Optional[Tracer]:
+    return _current_tracer.get()
+
+def stop_trace():
+    """Detach the current tracer (pool processes are reused across jobs)"""
+    _current_tracer.set(None)
@@ -0,0 +1,463 @@
+"""
+Hard-constraint verifier for timetable schedules
+Independent of the scheduler: rebuilds occupancy bitsets from the schedule
+entries in one pass and reports every violated hard constraint.
+
+Usage:
+python verifier.py schedule.json [problem.json]
+
+schedule.json is a scheduler result (or just its 'schedule' list);
+problem.json defaults to DATA from input.py.
+"""
+
+from typing import List, Dict, Tuple, Optional, Iterable, Callable
+from collections import defaultdict
+import json
+import sys
+import time
+
+DAY_NAMES = ["Sunday", "Monday", "Tuesday", "Wednesday", "Thursday"]
+PERIODS_PER_DAY = 8
+
+def day_index(day) -> Optional[int]:
+    """0-based day of an entry's 'day' (a name or an index), None if it is not a day of the week"""
+    if isinstance(day, str):
+        return DAY_NAMES.index(day) if day in DAY_NAMES else None
+    if isinstance(day, int) and not isinstance(day, bool) and 0 <= day < len(DAY_NAMES):
+        return day
+    return None
+
+# ==================== PRECEDENCE ====================
+
+def precedence_rules(data: Dict) -> Dict[str, List[Tuple[str, str, int, bool]]]:
+    """
+    course_id -> [(before type, after type, min gap days, same day)]. Each
+    section's `after` session must start once its `before` session is
+    over, at least min gap days later (or on the same day). Rules come from
+    kinds flagged requires_lecture_first (requiresLectureFirst in the mock
+    data) and from data['precedence'] entries, which apply to every course
+    unless they name a course_id.
+    """
+    rules = defaultdict(list)
+    for course in data['courses']:
+        course_id = course['course_id']
+        types = {k['type'] for k in course['kinds']}
+        for kind in course['kinds']:
+            if kind['type'] != "Lecture" and "Lecture" in types and \
+                    kind.get('requires_lecture_first', kind.get('requiresLectureFirst', False)):
+                rules[course_id].append(("Lecture", kind['type'], 0, False))
+        for entry in data.get('precedence', []):
+            if entry.get('course_id', course_id) != course_id:
+                continue
+            if entry['before'] in types and entry['after'] in types and entry['before'] != entry['after']:
+                rules[course_id].append((entry['before'], entry['after'], entry.get('min_gap_days', 0),
+                                         entry.get('same_day', False)))
+    return dict(rules)
+
+# ==================== WORKLOAD LIMITS ====================
+
+# Longest run of set bits in each day byte (consecutive busy periods)
+LONGEST_RUN = [max((len(run) for run in format(b, "b").split("0")), default=0) for b in range(256)]
+
+def workload_limits(data: Dict) -> Dict[str, Tuple[int, int, int]]:
+    """
+    'sections' / 'instructors' -> (max periods per day, max consecutive
+    periods, min days per week) from data['workload_limits'], e.g.
+    {"sections": {"max_periods_per_day": 6, "max_consecutive_periods": 4,
+    "min_days_per_week": 3}}. Unset limits do not bind; entities absent
+    from the input are left out. Min days never asks for more days than
+    the entity has sessions.
+    """
+    limits = {}
+    for entity, entry in (data.get('workload_limits') or {}).items():
+        limits[entity] = (entry.get('max_periods_per_day') or PERIODS_PER_DAY,
+                          entry.get('max_consecutive_periods') or PERIODS_PER_DAY,
+                          entry.get('min_days_per_week') or 0)
+    return limits
+
+# ==================== BUILDING TRAVEL ====================
+
+def building_travel(data: Dict) -> Optional[Tuple[str, int, Callable[[str, str], int]]]:
+    """
+    (mode, max distance, distance(building, building)) from
+    data['building_distances'] ({"B18": {"B07": 3, ...}, ...}: symmetric,
+    any unit, pairs left out count default_distance) and
+    data['building_travel'] ({"mode": "hard" | "soft", "max_distance": 0,
+    "default_distance": 1}). Back-to-back sessions of a section or
+    instructor (consecutive periods of one day) may not be further apart
+    than max_distance in hard mode; soft mode adds every distance to the
+    travel penalty instead. None without a distance matrix.
+    """
+    distances = data.get('building_distances')
+    if not distances:
+        return None
+    options = data.get('building_travel') or {}
+    default = options.get('default_distance', 1)
+
+    def distance(a: str, b: str) -> int:
+        if a == b:
+            return 0
+        d = distances.get(a, {}).get(b, distances.get(b, {}).get(a))
+        return default if d is None else d
+
+    return options.get('mode', "hard"), options.get('max_distance', 0), distance
+
+# ==================== VERIFIER ====================
+
+class ScheduleVerifier:
+    def __init__(self, data: Dict):
+        self.rooms = {r['room_id']: r for r in data['rooms']}
+        self.instructors = {i['instr_id']: i for i in data['instructors']}
+        self.groups = {g['group_id']: g for g in data['groups']}
+        self.sections = {s['section_id']: s for s in data['sections']}
+        self.courses = {c['course_id']: c for c in data['courses']}
+
+        # (course_id, session_type) -> kind dict
+        self.kinds = {}
+        for c in data['courses']:
+            for k in c['kinds']:
+                self.kinds.setdefault((c['course_id'], k['type']), k)
+
+        # Students with identical enrollments share one cluster; clusters
+        # inside a single section are covered by the section check
+        self.cluster_sizes = []
+        self.clusters_by_enrollment = defaultdict(list)  # (course_id, section_id) -> [cluster, ...]
+        students_by_enrollment = defaultdict(int)
+        for student in data.get('students', []):
+            enrollments = frozenset((e['course_id'], e['section_id']) for e in student['enrollments'])
+            students_by_enrollment[enrollments] += 1
+        for enrollments, count in students_by_enrollment.items():
+            if len({section_id for _, section_id in enrollments}) < 2:
+                continue
+            cluster = len(self.cluster_sizes)
+            self.cluster_sizes.append(count)
+            for enrollment in enrollments:
+                self.clusters_by_enrollment[enrollment].append(cluster)
+
+        self.precedence = precedence_rules(data)
+        self.workload = workload_limits(data)
+        self.travel = building_travel(data)
+
+        # Every section takes each session type of its year's courses (its major's or common ones)
+        self.required = defaultdict(list)  # (course_id, session_type) -> [section_id, ...]
+        for section in data['sections']:
+            group = self.groups.get(section['group_id'])
+            if group is None:
+                continue
+            for c in data['courses']:
+                if c['year'] != group['year'] or c.get('major') not in (None, group.get('specialization')):
+                    continue
+                for session_type in dict.fromkeys(k['type'] for k in c['kinds']):
+                    self.required[(c['course_id'], session_type)].append(section['section_id'])
+
+    def verify(self, schedule: Iterable[Dict]) -> Dict:
+        """Check a schedule in the _extract_solution format"""
+        start_time = time.time()
+        violations = []
+
+        # Entries are one row per attending section; fold them back into sessions
+        sessions = {}  # (course, type, day, start, duration, instructor, room) -> [section_id, ...]
+        listed = set()  # (course_id, session_type, section_id)
+        entries = 0
+        for entry in schedule:
+            entries += 1
+            day = entry.get('day')
+            day = day_index(day) if day_index(day) is not None else day  # Invalid days are kept for the report
+            key = (entry.get('course_id'), entry.get('type', entry.get('session_type')), day,
+                   entry.get('start_period'), entry.get('duration_periods'),
+                   entry.get('instructor_id'), entry.get('room_id'))
+            sessions.setdefault(key, []).append(entry.get('section_id'))
+            listed.add((key[0], key[1], entry.get('section_id')))
+
+        starts = {}  # (course_id, session_type, section_id) -> (day, period, duration)
+        buildings = defaultdict(dict)  # ('section' | 'instructor', id) -> slot -> (building, session key)
+        section_busy = defaultdict(int)
+        instructor_busy = defaultdict(int)
+        room_busy = defaultdict(int)
+        cluster_busy = defaultdict(int)
+        # entity -> [(mask, label)] so overlaps can name the other session
+        owners = defaultdict(list)
+
+        for key, section_ids in sessions.items():
+            course_id, session_type, day, start_period, duration, instructor_id, room_id = key
+            label = f"{course_id} ({session_type})"
+
+            kind = self.kinds.get((course_id, session_type))
+            course = self.courses.get(course_id)
+            if kind is None or course is None:
+                violations.append(self._violation('unknown_session', f"Unknown session {label}"))
+                continue
+
+            # Alignment and bounds
+            if day_index(day) is None:
+                violations.append(self._violation('alignment', f"{label} has unknown day {day!r}"))
+                continue
+            if start_period is None or duration is None:
+                violations.append(self._violation('alignment', f"{label} has no valid day/period"))
+                continue
+            period = start_period - 1
+            if duration != kind['length'] // 45:
+                violations.append(self._violation(
+                    'alignment', f"{label} lasts {duration} periods, expected {kind['length'] // 45}"))
+            if period < 0 or period + duration > PERIODS_PER_DAY:
+                violations.append(self._violation(
+                    'alignment', f"{label} on {DAY_NAMES[day]} period {start_period} runs past the day"))
+                continue
+            if duration == 2 and period % 2 != 0:
+                violations.append(self._violation(
+                    'alignment', f"{label} on {DAY_NAMES[day]} starts at period {start_period}, "
+                                 f"90-minute sessions must start on an odd period"))
+
+            mask = ((1 << duration) - 1) << (day * PERIODS_PER_DAY + period)
+            where = f"{DAY_NAMES[day]} period {start_period}"
+            for section_id in section_ids:
+                starts[(course_id, session_type, section_id)] = (day, period, duration)
+
+            # Section overlaps
+            students_count = 0
+            for section_id in section_ids:
+                section = self.sections.get(section_id)
+                if section is None:
+                    violations.append(self._violation('unknown_section', f"{label} lists unknown section {section_id}"))
+                    continue
+                students_count += section['students_count']
+                self._occupy(section_busy, owners, ('section', section_id), mask, label,
+                             f"Section {section_id}", where, 'section_overlap', violations)
+
+            # Student overlaps across sections
+            clusters = {cluster for section_id in section_ids
+                        for cluster in self.clusters_by_enrollment.get((course_id, section_id), ())}
+            for cluster in clusters:
+                self._occupy(cluster_busy, owners, ('students', cluster), mask, label,
+                             f"{self.cluster_sizes[cluster]} student(s) of cluster {cluster}", where,
+                             'student_overlap', violations)
+
+            # Instructor role, qualification and overlaps (projects may be unsupervised)
+            instructor = self.instructors.get(instructor_id)
+            if instructor_id == "N/A" and course.get('is_project', False):
+                pass
+            elif instructor is None:
+                violations.append(self._violation('unknown_instructor', f"{label} has unknown instructor {instructor_id}"))
+            else:
+                expected_role = "Professor" if session_type == "Lecture" else "TA"
+                if instructor['role'] != expected_role:
+                    violations.append(self._violation(
+                        'role_mismatch', f"{label} taught by {instructor_id} ({instructor['role']}), "
+                                         f"expected {expected_role}"))
+                if course_id not in instructor['qualified_courses']:
+                    violations.append(self._violation(
+                        'role_mismatch', f"{instructor_id} is not qualified for {course_id}"))
+                self._occupy(instructor_busy, owners, ('instructor', instructor_id), mask, label,
+                             f"Instructor {instructor_id}", where, 'instructor_overlap', violations)
+
+            # Room type, capacity and overlaps (graduation projects have no room)
+            if room_id == "N/A" and course.get('is_project', False):
+                continue
+            room = self.rooms.get(room_id)
+            if room is None:
+                violations.append(self._violation('unknown_room', f"{label} has unknown room {room_id}"))
+                continue
+
+            expected_types = self._room_types(session_type, kind)
+            if room['type'] not in expected_types:
+                violations.append(self._violation(
+                    'room_type', f"{label} in {room_id} ({room['type']}), expected {' or '.join(expected_types)}"))
+            if not kind.get('ignore_capacity', False) and room['capacity'] < students_count:
+                violations.append(self._violation(
+                    'capacity', f"{label} has {students_count} students in {room_id} "
+                                f"(capacity {room['capacity']})"))
+            self._occupy(room_busy, owners, ('room', room_id), mask, label,
+                         f"Room {room_id}", where, 'room_overlap', violations)
+
+            if self.travel is not None:
+                first_slot = day * PERIODS_PER_DAY + period
+                entities = [('section', section_id) for section_id in section_ids]
+                if instructor_id != "N/A":
+                    entities.append(('instructor', instructor_id))
+                for entity in entities:
+                    for slot in range(first_slot, first_slot + duration):
+                        buildings[entity][slot] = (room.get('building'), key)
+
+        # Coverage: a schedule that drops sessions is not a valid timetable
+        for (course_id, session_type), section_ids in self.required.items():
+            missing = [section_id for section_id in section_ids if (course_id, session_type, section_id) not in listed]
+            if missing:
+                violations.append(self._violation(
+                    'missing_session', f"{course_id} ({session_type}) is not scheduled for {', '.join(missing)}"))
+
+        self._check_precedence(starts, violations)
+        travel_penalty = self._check_travel(buildings, violations)
+        self._check_workload('sections', "Section", section_busy, owners, violations)
+        self._check_workload('instructors', "Instructor", instructor_busy, owners, violations)
+
+        counts = defaultdict(int)
+        for v in violations:
+            counts[v['type']] += 1
+
+        result = {
+            'valid': not violations,
+            'entries': entries,
+            'sessions': len(sessions),
+            'violations': violations,
+            'counts': dict(counts),
+            'verify_time': time.time() - start_time
+        }
+        if self.travel is not None:
+            result['travel_penalty'] = travel_penalty
+        return result
+
+    def _check_precedence(self, starts: Dict, violations: List[Dict]):
+        """Every section's ordered session pairs (precedence_rules)"""
+        for (course_id, session_type, section_id), (day, period, duration) in starts.items():
+            for before, after, gap, same_day in self.precedence.get(course_id, ()):
+                if after != session_type or (course_id, before, section_id) not in starts:
+                    continue
+                problem = self.precedence_problem(f"{course_id} ({after}) for {section_id}", (day, period),
+                                                  before, starts[(course_id, before, section_id)], gap, same_day)
+                if problem:
+                    violations.append(self._violation('precedence', problem))
+
+    @staticmethod
+    def precedence_problem(label: str, start: Tuple[int, int], before: str, before_start: Tuple[int, int, int],
+                           gap: int, same_day: bool) -> Optional[str]:
+        """Why a session starting at (day, period) breaks one rule against its before session, None if it does not"""
+        day, period = start
+        before_day, before_period, before_duration = before_start
+        if (day, period) < (before_day, before_period + before_duration):
+            return f"{label} on {DAY_NAMES[day]} period {period + 1} starts before its {before} is over"
+        if same_day and day != before_day:
+            return f"{label} on {DAY_NAMES[day]}, expected the day of its {before} ({DAY_NAMES[before_day]})"
+        if not same_day and day < before_day + gap:
+            return f"{label} on {DAY_NAMES[day]} is less than {gap} day(s) after its {before}"
+        return None
+
+    def _check_workload(self, entity: str, name: str, busy: Dict, owners: Dict, violations: List[Dict]):
+        """Per-day periods, consecutive periods and days per week of every section / instructor"""
+        if entity not in self.workload:
+            return
+        kind = entity[:-1]
+        for entity_id, mask in busy.items():
+            for problem in self.workload_problems(entity, name, entity_id, mask, len(owners[(kind, entity_id)])):
+                violations.append(self._violation('workload', problem))
+
+    def workload_problems(self, entity: str, name: str, entity_id: str, mask: int, sessions: int) -> List[str]:
+        """Workload limits ('sections' / 'instructors') one entity breaks with these busy slots and sessions"""
+        if entity not in self.workload:
+            return []
+        max_periods, max_consecutive, min_days = self.workload[entity]
+        problems = []
+        days_used = 0
+        for day in range(len(DAY_NAMES)):
+            periods = mask >> (day * PERIODS_PER_DAY) & 0xFF
+            if not periods:
+                continue
+            days_used += 1
+            if periods.bit_count() > max_periods:
+                problems.append(f"{name} {entity_id} has {periods.bit_count()} periods on {DAY_NAMES[day]}, "
+                                f"limit {max_periods}")
+            if LONGEST_RUN[periods] > max_consecutive:
+                problems.append(f"{name} {entity_id} has {LONGEST_RUN[periods]} consecutive periods on "
+                                f"{DAY_NAMES[day]}, limit {max_consecutive}")
+        needed = min(min_days, sessions)
+        if days_used < needed:
+            problems.append(f"{name} {entity_id} is scheduled on {days_used} day(s), expected at least {needed}")
+        return problems
+
+    def _check_travel(self, buildings: Dict, violations: List[Dict]) -> int:
+        """
+        Back-to-back sessions in different buildings: hard mode reports those
+        further apart than max_distance, soft mode sums the distances
+        (returned as the travel penalty)
+        """
+        if self.travel is None:
+            return 0
+        mode, _, distance = self.travel
+        penalty = 0
+        for (kind, entity_id), slots in buildings.items():
+            for slot, (building, key) in slots.items():
+                if (slot + 1) % PERIODS_PER_DAY == 0 or slot + 1 not in slots:
+                    continue
+                next_building, next_key = slots[slot + 1]
+                if next_key == key:
+                    continue
+                if mode == "soft":
+                    penalty += distance(building, next_building)
+                elif self.travel_blocked(building, next_building):
+                    day, period = divmod(slot + 1, PERIODS_PER_DAY)
+                    violations.append(self._violation(
+                        'building_travel', f"{kind.capitalize()} {entity_id} goes from {building} to "
+                                           f"{next_building} with no break on {DAY_NAMES[day]} period {period + 1}"))
+        return penalty
+
+    def travel_blocked(self, building: str, other: str) -> bool:
+        """Back-to-back sessions in these buildings break the hard travel rule"""
+        if self.travel is None or self.travel[0] != "hard" or building is None or other is None:
+            return False
+        return self.travel[2](building, other) > self.travel[1]
+
+    @staticmethod
+    def _room_types(session_type: str, kind: Dict) -> Tuple[str, ...]:
+        """Room types a session of this kind may use"""
+        if session_type == "Lab":
+            return (kind.get('lab_type'),)
+        if session_type == "Lecture":
+            return ("theater",) if kind.get('ignore_capacity', False) else ("classroom", "theater")
+        return ("classroom",)
+
+    def _occupy(self, busy: Dict, owners: Dict, entity: Tuple[str, str], mask: int, label: str,
+                name: str, where: str, violation_type: str, violations: List[Dict]):
+        """Mark the slots busy for an entity, reporting each session it overlaps"""
+        entity_id = entity[1]
+        if busy[entity_id] & mask:
+            for other_mask, other_label in owners[entity]:
+                if other_mask & mask:
+                    violations.append(self._violation(
+                        violation_type, f"{name} double-booked on {where}: {other_label} and {label}"))
+        busy[entity_id] |= mask
+        owners[entity].append((mask, label))
+
+    @staticmethod
+    def _violation(violation_type: str, message: str) -> Dict:
+        return {'type': violation_type, 'message': message}
+
+# ==================== API ====================
+
+def verify_schedule(data: Dict, schedule: Iterable[Dict]) -> Dict:
+    """
+    Entry point for verification
+
+    Args:
+        data: Input data dictionary the schedule was solved for
+        schedule: Entries in the _extract_solution format (any iterable)
+    """
+    return ScheduleVerifier(data).verify(schedule)
+
+# ==================== CLI ====================
+
+if __name__ == "__main__":
+    if len(sys.argv) < 2:
+        print(__doc__)
+        sys.exit(2)
+
+    with open(sys.argv[1]) as f:
+        loaded = json.load(f)
+    schedule = loaded['schedule'] if isinstance(loaded, dict) else loaded
+
+    if len(sys.argv) > 2:
+        with open(sys.argv[2]) as f:
+            data = json.load(f)
+    else:
+        from input import DATA as data
+
+    report = verify_schedule(data, schedule)
+
+    for v in report['violations']:
+        print(f"[{v['type']}] {v['message']}")
+
+    print(f"\nEntries: {report['entries']:,} ({report['sessions']:,} sessions)")
+    print(f"Violations: {len(report['violations']):,}")
+    for violation_type, count in sorted(report['counts'].items()):
+        print(f"  {violation_type}: {count}")
+    print(f"Time: {report['verify_time'] * 1000:.2f}ms")
+
+    sys.exit(0 if report['valid'] else 1)